@@ -39,6 +39,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 
 
@@ -120,6 +121,25 @@ CUTL_API Cutl *cutl_new(const char *name);
 CUTL_API void cutl_free(Cutl *cutl);
 
 
+/** Allocates memory that lives as long as the test context.
+ * Returns a block of `size` bytes, zero-initialized and suitably aligned for
+ * any type, that stays valid until the call to cutl_run() that created the
+ * test context returns, whether the test passed, failed or was interrupted.
+ * The blocks of the top-level test context are released by cutl_free().
+ *
+ * Blocks are carved out of chunks owned by the test context, which are all
+ * released at once: they must **not** be freed individually. The library
+ * exits if the memory cannot be allocated.
+ */
+CUTL_API void *cutl_alloc(Cutl *cutl, size_t size);
+
+
+/** Duplicates a string in memory that lives as long as the test context.
+ * Same as cutl_alloc(), but with a copy of the null-terminated string `str`.
+ */
+CUTL_API char *cutl_strdup(Cutl *cutl, const char *str);
+
+
 
 /// \name SETTINGS
 
@@ -135,6 +155,99 @@ CUTL_API void cutl_set_output(Cutl *cutl, FILE *output);
 CUTL_API FILE *cutl_get_output(const Cutl *cutl);
 
 
+/** Sets whether messages are written to the output by a separate thread.
+ * If `is_async` is true, then the lines printed by the tests are queued and
+ * written by a background thread, so that tests don't wait on a slow output.
+ * Lines are written in the same order as otherwise, and are all written by the
+ * time cutl_summary() or cutl_free() return, or before the program exits from
+ * cutl_interrupt(). The output must stay open until then. Otherwise lines are
+ * written as they are printed, which is the default.
+ *
+ * If #CUTL_USE_PTHREAD was not defined at build time, then this setting is
+ * ignored.
+ *
+ * This setting is shared by the whole tree of tests.
+ */
+CUTL_API void cutl_set_async(Cutl *cutl, bool is_async);
+
+/** Returns whether messages are written by a separate thread, as set by
+ * cutl_set_async().
+ */
+CUTL_API bool cutl_get_async(const Cutl *cutl);
+
+
+/** Formats of the reports written next to the output.
+ * To be used with cutl_set_report(). Reports of several formats can be written
+ * at the same time.
+ */
+typedef enum {
+	/** No report, the default. */
+	CUTL_NO_REPORT = 0,
+
+	/** JUnit XML, as read by continuous integration servers.
+	 * Suites become nested `testsuite` elements and tests `testcase`
+	 * elements, with their duration, failures and other messages. The
+	 * elements are written as the tests end, so their counts are left for
+	 * readers to add up.
+	 */
+	CUTL_JUNIT = 1,
+
+	/** TAP version 14. Test points are written as tests end, without
+	 * numbers, and suites become subtests. Plans come last, and messages
+	 * are kept in the YAML block of their test.
+	 */
+	CUTL_TAP = 2,
+
+	/** JSON Lines, one event per line, for tools to read as it streams.
+	 * Events are `test_start`, `message`, `test_end` and, last, `summary`.
+	 * Each has the `id` and `parent` id of its test, its `key` (a hash of
+	 * its path that is the same from run to run), its `depth` and its
+	 * `path` of names. Messages add their `severity`, `file`, `line` and
+	 * `text`, ends the `status` ("passed", "failed" or "canceled"), the
+	 * counts of `passed`, `failed` and `skipped` tests and, but for the
+	 * summary, whether it is a `suite` and its `duration` and
+	 * `cpu_duration` in seconds. Ids of tests run by workers, see
+	 * cutl_set_jobs(), are only unique within their job.
+	 */
+	CUTL_JSON = 4,
+
+	/** Binary log of #Cutl_Log_Record records, for runs too large for
+	 * text reports. Names, files and texts are written once, then
+	 * referred to by id. Logs are turned into text, JSON or a summary by
+	 * the `cutl-decode` tool.
+	 */
+	CUTL_BINARY = 8,
+} Cutl_Format;
+
+
+/** Sets the file where the report of a format is written.
+ * The `format` parameter should be a #Cutl_Format value. The report is written
+ * as the tests end, and completed by cutl_summary() or cutl_free(), after
+ * which nothing more is written to the file. If `report` is NULL, then no
+ * report of this format is written, which is the default. If `format` is
+ * #CUTL_NO_REPORT, then all reports are completed and none is written
+ * anymore. The file is not closed by the library. A report in progress is
+ * completed before another one of the same format is set.
+ *
+ * Tests run in parallel jobs, see cutl_set_jobs(), keep their reports in
+ * memory until they are joined. Workers send them back along with their
+ * output, those that don't fit are left out.
+ *
+ * This setting is shared by the whole tree of tests, and should be set before
+ * running any.
+ */
+CUTL_API void cutl_set_report(Cutl *cutl, int format, FILE *report);
+
+/** Returns the file where the report of a format is written, as set by
+ * cutl_set_report().
+ */
+CUTL_API FILE *cutl_get_report(const Cutl *cutl, int format);
+
+/** Returns the formats of the reports being written, combined.
+ */
+CUTL_API int cutl_get_report_format(const Cutl *cutl);
+
+
 /**The types of messages that can be displayed.
  * Used with cutl_message_at() or combined and used with cutl_set_verbosity().
  */
@@ -178,6 +291,14 @@ typedef enum {
 	 * cutl_message_at().
 	 */
 	CUTL_SUITES = 64,
+
+	/** Durations of tests.
+	 * This type is used internally to display the wall-clock and processor
+	 * time of tests and suites along with their result, as well as their
+	 * heap usage when accounted, see cutl_set_leaks(). It should not be
+	 * used with cutl_message_at().
+	 */
+	CUTL_TIMES = 128,
 } Cutl_VerbObj;
 
 
@@ -195,7 +316,7 @@ typedef enum {
 	CUTL_NORMAL = (CUTL_MINIMAL | CUTL_INFO | CUTL_SUITES),
 
 	/** Display everything */
-	CUTL_VERBOSE = (CUTL_NORMAL | CUTL_TESTS),
+	CUTL_VERBOSE = (CUTL_NORMAL | CUTL_TESTS | CUTL_TIMES),
 } Cutl_VerbLvl;
 
 
@@ -250,10 +371,412 @@ CUTL_API void cutl_set_indent(Cutl *cutl, const char *indent);
 CUTL_API const char *cutl_get_indent(const Cutl *cutl);
 
 
+/** Sets the maximum number of parallel jobs.
+ * If the `jobs` parameter is greater than one, then the children tests of the
+ * test context are each run in a separate worker process, with at most `jobs`
+ * workers running at the same time. Suites run with cutl_run_as_suite() are
+ * not farmed out: they run in the current process and their own children are
+ * farmed out instead. Otherwise, the whole test runs inside its worker.
+ * Workers never run tests in parallel threads.
+ * If `jobs` is lower than one, then the default value (1) is used instead.
+ *
+ * The output of each worker is buffered and displayed in the same order as if
+ * the tests were run one after the other. Results are only merged into the
+ * test context once the children are joined, which happens before any message
+ * is printed for the test context, before running a suite or an anonymous
+ * test, and when the test context ends.
+ *
+ * If #CUTL_USE_FORK was not defined at build time, then tests are always run
+ * one after the other.
+ *
+ * Children tests inherit this setting.
+ */
+CUTL_API void cutl_set_jobs(Cutl *cutl, int jobs);
+
+/** Returns the current maximum number of parallel jobs, as set by
+ * cutl_set_jobs().
+ */
+CUTL_API int cutl_get_jobs(const Cutl *cutl);
+
+
+/** Sets whether each test is run in its own worker process.
+ * If `is_isolated` is true, then the children tests of the test context are
+ * run in worker processes as with cutl_set_jobs(), even when only one job is
+ * allowed, so that the state they corrupt, crashes and calls to `exit()` stay
+ * in their worker. Tests are still run one after the other, unless more jobs
+ * are allowed. Otherwise tests are only run in workers when there is more than
+ * one job, which is the default.
+ *
+ * If #CUTL_USE_MMAP was defined at build time, then workers send their output
+ * back through shared memory, up to 1 MiB each. If #CUTL_USE_FORK was not
+ * defined at build time, then this setting is ignored.
+ *
+ * Children tests inherit this setting.
+ */
+CUTL_API void cutl_set_isolated(Cutl *cutl, bool is_isolated);
+
+/** Returns whether each test is run in its own worker process, as set by
+ * cutl_set_isolated().
+ */
+CUTL_API bool cutl_get_isolated(const Cutl *cutl);
+
+
+/** Sets the number of threads running tests in parallel.
+ * If the `threads` parameter is greater than one, then the children tests of
+ * the test context, suites included, are run on a pool of threads, in the
+ * current process. Each thread runs the tests it spawned first and, once it
+ * runs out, steals the oldest pending test of another thread, so that large
+ * nested suites are spread over idle threads. As with cutl_set_jobs(), output
+ * is displayed in order and results are merged once the children are joined.
+ * If `threads` is lower than one, then the default value (1) is used instead.
+ *
+ * Children tests run at the same time and must not share mutable state without
+ * synchronization, including through the `at_start` and `at_end` functions.
+ * Suites that do should leave, or set, this setting to 1. The thread pool is
+ * shared by the whole tree of tests and grows up to the largest number of
+ * threads requested. Parallel jobs take precedence over threads.
+ *
+ * If #CUTL_USE_PTHREAD was not defined at build time, then tests are always
+ * run one after the other.
+ *
+ * Children tests inherit this setting.
+ */
+CUTL_API void cutl_set_parallel(Cutl *cutl, int threads);
+
+/** Returns the current number of threads, as set by cutl_set_parallel().
+ */
+CUTL_API int cutl_get_parallel(const Cutl *cutl);
+
+
+/** Sets the shard of tests to run.
+ * If the `count` parameter is greater than one, then the children tests of the
+ * test context are split into `count` shards and only those of the shard
+ * `index`, from 1 to `count`, are run. This allows spreading a test sequence
+ * over several processes or machines, each running one of the shards.
+ *
+ * Tests are assigned to shards from a hash of their full name, which is made
+ * of the names of their parents and their own. It does not change when other
+ * tests are added or removed. Suites run with cutl_run_as_suite() are always
+ * run so that their children can be sharded, while any other test is either
+ * run whole or skipped. Skipped tests are not counted at all. If a timings
+ * file with the previous durations of the tests was loaded, see
+ * cutl_set_timings(), then the tests it lists are instead spread so that all
+ * shards take about as long, longest tests first.
+ *
+ * If `count` is lower than two, or `index` is not between 1 and `count`, then
+ * sharding is disabled, which is the default.
+ *
+ * Children tests inherit this setting, except for the tests of the shard which
+ * run all of their children.
+ */
+CUTL_API void cutl_set_shard(Cutl *cutl, int index, int count);
+
+/** Returns the current shard index, as set by cutl_set_shard().
+ * If `count` is not NULL, then the number of shards is stored in it.
+ */
+CUTL_API int cutl_get_shard(const Cutl *cutl, int *count);
+
+
+/** Adds a pattern selecting the tests to run by their path.
+ * The path of a test is made of the names of its parents, the root left out,
+ * and its own, joined with '/', as in "suite/test". In patterns, '*' matches
+ * any characters but '/', "**" any characters, and '?' any one character but
+ * '/'. A pattern matching a suite also matches all of its tests.
+ *
+ * If there are patterns that are not `is_excluded`, then only the tests that
+ * match one of them are run. Tests that match a pattern that is
+ * `is_excluded` are never run. Tests are filtered before their `at_start`
+ * function is called, and skipped ones are not counted at all. Suites run
+ * with cutl_run_as_suite() are only run if one of their tests could match,
+ * while any other test is either run whole or skipped, as with shards, see
+ * cutl_set_shard().
+ *
+ * The `pattern` pointer must be valid for the duration of the test. If it is
+ * NULL, then all the patterns are removed and every test is run, which is the
+ * default.
+ *
+ * This setting is shared by the whole tree of tests.
+ */
+CUTL_API void cutl_add_filter(
+	Cutl *cutl, const char *pattern, bool is_excluded);
+
+/** Returns the pattern at `index`, in the order they were added by
+ * cutl_add_filter(), or NULL if there are not that many.
+ * If `is_excluded` is not NULL, then whether the pattern excludes tests is
+ * stored in it.
+ */
+CUTL_API const char *cutl_get_filter(
+	const Cutl *cutl, int index, bool *is_excluded);
+
+
+/** Sets the file storing the duration of tests.
+ * The durations of the tests previously written in the file at `path`, if
+ * any, are loaded and used to balance shards, see cutl_set_shard(). The
+ * durations of the tests that are run are then written back to the file by
+ * cutl_summary(), along with the previous durations of the tests that were
+ * not run. The files written by the different shards can be concatenated.
+ *
+ * Only the tests that are sharded have their duration written, any test
+ * except suites run with cutl_run_as_suite() and the children of tests. The
+ * `path` pointer must be valid for the duration of the test. If it is NULL,
+ * then durations are neither loaded nor written, which is the default.
+ *
+ * This setting is shared by the whole tree of tests.
+ */
+CUTL_API void cutl_set_timings(Cutl *cutl, const char *path);
+
+/** Returns the path of the timings file, as set by cutl_set_timings().
+ */
+CUTL_API const char *cutl_get_timings(const Cutl *cutl);
+
+
+/** Sets the file storing the baseline of benchmarks.
+ * The samples of the benchmarks previously written in the file at `path`, if
+ * any, are loaded, and each benchmark run with cutl_bench() is compared with
+ * its own: it fails if a one-sided Mann-Whitney U test finds it slower at the
+ * 1% significance level, and if its median is slower by more than the
+ * threshold set by cutl_set_regression().
+ *
+ * The samples of the benchmarks that are not yet in the file are then written
+ * to it by cutl_summary(), while the others keep their baseline so that small
+ * slowdowns don't add up. Remove their lines, or the file, to take a new
+ * baseline. Benchmarks run by a server, see cutl_run_as_server(), are compared
+ * but not written. The `path` pointer must be valid for the duration of the
+ * test. If it is NULL, then benchmarks are neither compared nor written, which
+ * is the default.
+ *
+ * This setting is shared by the whole tree of tests.
+ */
+CUTL_API void cutl_set_baseline(Cutl *cutl, const char *path);
+
+/** Returns the path of the baseline file, as set by cutl_set_baseline().
+ */
+CUTL_API const char *cutl_get_baseline(const Cutl *cutl);
+
+
+/** Sets the file caching the results of tests.
+ * Whether each test passed or failed, and its duration, previously written in
+ * the file at `path` are loaded, and used to run the tests that failed first,
+ * see cutl_set_failed_first(). The results of the tests that are run are
+ * then written back to the file by cutl_summary(), along with the previous
+ * results of the tests that were not run.
+ *
+ * As with timings, see cutl_set_timings(), only the tests that could be
+ * sharded are cached. The `path` pointer must be valid for the duration of
+ * the test. If it is NULL, then results are neither loaded nor written,
+ * which is the default.
+ *
+ * This setting is shared by the whole tree of tests.
+ */
+CUTL_API void cutl_set_cache(Cutl *cutl, const char *path);
+
+/** Returns the path of the cache file, as set by cutl_set_cache().
+ */
+CUTL_API const char *cutl_get_cache(const Cutl *cutl);
+
+
+/** Sets whether the tests that failed last time are run first.
+ * If `is_failed_first` is true, then cutl_run_registered() runs the tests that
+ * failed according to the cache, see cutl_set_cache(), then the tests that
+ * are not in the cache, then the others, shortest first. Suites are run in
+ * the same order, ranked by their first test, so that the first failure
+ * comes as early as possible. Tests run with cutl_run() are always run in the
+ * order they are called.
+ *
+ * The order is planned when the registered tests are first run or listed,
+ * this setting must be set before. It is disabled by default.
+ *
+ * This setting is shared by the whole tree of tests.
+ */
+CUTL_API void cutl_set_failed_first(Cutl *cutl, bool is_failed_first);
+
+/** Returns whether failed tests are run first, as set by
+ * cutl_set_failed_first().
+ */
+CUTL_API bool cutl_get_failed_first(const Cutl *cutl);
+
+
+/** Sets whether the tests whose code is unchanged are skipped.
+ * If `is_incremental` is true, then the functions entered by each test are
+ * written in the cache, see cutl_set_cache(), along with a fingerprint of
+ * their code. Tests that passed last time are then skipped as long as the
+ * code of their functions is the same in the program, and skipped tests are
+ * not counted at all. Tests that failed, or that entered no function, are
+ * always run.
+ *
+ * Functions are only known once the code under test is built with the
+ * `-finstrument-functions` option of GCC or Clang, which calls the library
+ * when they are entered. The library itself is always built without it.
+ * Functions are then found by name in the symbol tables of the program and
+ * of its libraries, which must not be stripped. The functions entered by
+ * tests nested in another one count for the outermost test that could be
+ * sharded, see cutl_set_shard(), which is the one skipped. Functions entered
+ * by other threads than the one running the test are missed.
+ *
+ * It is disabled by default. If #CUTL_INCREMENTAL_ENABLED is not defined,
+ * then no function is known and no test is skipped.
+ *
+ * This setting is shared by the whole tree of tests.
+ */
+CUTL_API void cutl_set_incremental(Cutl *cutl, bool is_incremental);
+
+/** Returns whether unchanged tests are skipped, as set by
+ * cutl_set_incremental().
+ */
+CUTL_API bool cutl_get_incremental(const Cutl *cutl);
+
+
+/** Sets the number of slowest tests listed by cutl_summary().
+ * The `count` tests that took the longest, by wall-clock time, are listed
+ * after the summary along with their duration, slowest first. Only tests that
+ * run no other test are listed, and not those run by a test handed to a
+ * parallel job, see cutl_set_jobs(). If `count` is 0 or less, then no test is
+ * listed, which is the default.
+ *
+ * This setting is shared by the whole tree of tests.
+ */
+CUTL_API void cutl_set_slowest(Cutl *cutl, int count);
+
+/** Returns the number of slowest tests listed, as set by cutl_set_slowest().
+ */
+CUTL_API int cutl_get_slowest(const Cutl *cutl);
+
+
+/** Sets the slowdown beyond which benchmarks fail, in percent.
+ * A benchmark only fails when compared with its baseline, see
+ * cutl_set_baseline(), if its median time is more than `percent` percent
+ * slower than the median of the baseline. If `percent` is negative, then the
+ * default value (10) is used instead.
+ *
+ * Children tests inherit this setting.
+ */
+CUTL_API void cutl_set_regression(Cutl *cutl, int percent);
+
+/** Returns the regression threshold, as set by cutl_set_regression().
+ */
+CUTL_API int cutl_get_regression(const Cutl *cutl);
+
+
+/** Enables counting events during benchmarks.
+ * If `has_counters` is true, then the cycles, instructions, cache misses and
+ * branch misses of the thread running a benchmark are counted while it is
+ * timed, see cutl_bench(), and displayed per call along with the number of
+ * instructions per cycle, in a #CUTL_INFO message following its timings. When
+ * hardware events are not available, as in virtual machines or containers
+ * with a restrictive `perf_event_paranoid`, the task clock, page faults and
+ * context switches are counted instead. If no event is available, then
+ * nothing is displayed.
+ *
+ * If #CUTL_USE_PERF_EVENT was not defined at build time, then this setting is
+ * ignored. It is disabled by default.
+ *
+ * Children tests inherit this setting.
+ */
+CUTL_API void cutl_set_counters(Cutl *cutl, bool has_counters);
+
+/** Returns whether events are counted, as set by cutl_set_counters().
+ */
+CUTL_API bool cutl_get_counters(const Cutl *cutl);
+
+
+/** Sets the maximum duration of tests, in milliseconds of wall-clock time.
+ * A test that runs for longer than `timeout` fails with a message telling how
+ * long it ran. Tests are interrupted as with cutl_interrupt(), so the code
+ * they run must allow it, when it does not then a test run in a forked
+ * process is killed instead, see cutl_set_parallel(). This requires threads,
+ * otherwise timeouts are ignored.
+ *
+ * Only the tests that are sharded are timed, see cutl_set_timings(), their
+ * children share the time of their parent. A test can override the timeout
+ * for itself by setting it on its own test context while it runs, the new
+ * timeout still counts from the start of the test. If `timeout` is 0 or less,
+ * then tests have no timeout, which is the default.
+ *
+ * Children tests inherit this setting.
+ */
+CUTL_API void cutl_set_timeout(Cutl *cutl, int timeout);
+
+/** Returns the maximum duration of tests, as set by cutl_set_timeout().
+ */
+CUTL_API int cutl_get_timeout(const Cutl *cutl);
+
+
+/** Sets the maximum processor time of tests, in milliseconds.
+ * Same as cutl_set_timeout(), but only the processor time used by the thread
+ * running the test counts, so that a test that is slowed down by a loaded
+ * machine, or that is waiting, does not time out. Tests time out on whichever
+ * limit they reach first, and the message tells when it is this one.
+ *
+ * If `timeout` is 0 or less, then tests have no processor time limit, which
+ * is the default.
+ *
+ * Children tests inherit this setting.
+ */
+CUTL_API void cutl_set_cpu_timeout(Cutl *cutl, int timeout);
+
+/** Returns the maximum processor time of tests, as set by
+ * cutl_set_cpu_timeout().
+ */
+CUTL_API int cutl_get_cpu_timeout(const Cutl *cutl);
+
+
+/** Sets how tests that crash are reported.
+ * If `type` is #CUTL_FAIL or #CUTL_ERROR, then a test that crashes with
+ * `SIGSEGV`, `SIGBUS`, `SIGFPE`, `SIGILL` or `SIGABRT` is interrupted and a
+ * message of this type names the signal. Errors also cancel the rest of the
+ * test sequence, which is safer since the crash may have corrupted the state
+ * of the process. Crashes are handled on an alternate stack, so that stack
+ * overflows are caught as well. Otherwise crashes are not handled, which is
+ * the default.
+ *
+ * Only crashes in the test functions are handled: a crash inside the library
+ * is still fatal. If #CUTL_USE_SIGACTION was not defined at build time, then
+ * this setting is ignored.
+ *
+ * Children tests inherit this setting.
+ */
+CUTL_API void cutl_set_guard(Cutl *cutl, int type);
+
+/** Returns how tests that crash are reported, as set by cutl_set_guard().
+ * Returns 0 if crashes are not handled.
+ */
+CUTL_API int cutl_get_guard(const Cutl *cutl);
+
+
+/** Sets how memory leaked by tests is reported.
+ * If `type` is #CUTL_WARN, #CUTL_FAIL or #CUTL_ERROR, then the blocks that
+ * the functions of a test allocate with `malloc()`, `calloc()` or `realloc()`
+ * are accounted to it, and those still allocated when cutl_run() returns are
+ * reported in a message of this type, along with their total size. The peak
+ * of allocated memory of each test is displayed with its duration, see
+ * #CUTL_TIMES, and the largest one is displayed by cutl_summary(). Otherwise
+ * allocations are not accounted, which is the default.
+ *
+ * Blocks are accounted to the innermost test run by the thread that allocates
+ * them, and can be freed by the tests it runs. Allocations made by the library
+ * itself or by other libraries are not accounted. If #CUTL_HEAP_ENABLED is
+ * not defined, then this setting is ignored.
+ *
+ * Children tests inherit this setting.
+ */
+CUTL_API void cutl_set_leaks(Cutl *cutl, int type);
+
+/** Returns how memory leaks are reported, as set by cutl_set_leaks().
+ * Returns 0 if allocations are not accounted.
+ */
+CUTL_API int cutl_get_leaks(const Cutl *cutl);
+
+
 /** Reads the settings from the command-line arguments.
  * Parses various short command-line options, including a `-h` option that
  * describes on the standard output the other available options and immediately
- * interrupts the test.
+ * interrupts the test. Likewise, the `-l` option lists on the standard output
+ * the tests run by cutl_run_registered(), those of the shard if any, see
+ * cutl_set_shard(), one "suite/name" per line, in the order they would run.
+ * The `-n` and `-u` options cache results next to the program, in a file
+ * named after `argv[0]` with a ".cache" suffix, unless a cache file is given
+ * with `-C`. The `-t` option sets the processor time limit instead, see
+ * cutl_set_cpu_timeout(), when its argument starts with "cpu:".
  *
  * If a non-option argument is encountered (any string not starting with '-'
  * followed by an alphanumerical character), then parsing is stopped. Invalid
@@ -388,11 +911,59 @@ CUTL_API void cutl_at_interrupt(Cutl *cutl, Cutl_Func *func, void *data);
  * `at_end` functions, and can be retrieved with cutl_get_data(). It can safely
  * be NULL.
  *
- * Returns the number of failed tests, by calling cutl_get_failed().
+ * Returns the number of failed tests, by calling cutl_get_failed(). If the
+ * test was handed to a parallel job or thread, see cutl_set_jobs() and
+ * cutl_set_parallel(), then it returns `0` and the result is merged into the
+ * parent test context later on.
  */
 CUTL_API int cutl_run(
 	Cutl *cutl, const char *name, Cutl_Func *test, void *data);
 
+/** Runs the suite of tests in a new test context.
+ * Same as cutl_run(), but marks the new test context as a suite: a test that
+ * mainly calls cutl_run(). Suites are never run by a parallel job, see
+ * cutl_set_jobs(); only their children are.
+ */
+CUTL_API int cutl_run_as_suite(
+	Cutl *cutl, const char *name, Cutl_Func *suite, void *data);
+
+/** Runs the suite of tests in a new worker process, which then forks a worker
+ * for each of its tests.
+ * Same as cutl_run_as_suite(), but the suite is always run by a parallel job,
+ * see cutl_set_jobs(), which acts as a template for its tests: whatever the
+ * suite sets up before running them, including in its `at_start` function, is
+ * set up once and shared copy-on-write by all of them. Each test starts from
+ * the state the suite left, whatever the tests before it did, and nothing
+ * leaks back into the calling process. Tests are forked one after the other,
+ * unless more jobs are allowed.
+ *
+ * If #CUTL_USE_FORK was not defined at build time, or if the suite is run by
+ * a parallel thread, see cutl_set_parallel(), then this is the same as
+ * cutl_run_as_suite().
+ */
+CUTL_API int cutl_run_as_server(
+	Cutl *cutl, const char *name, Cutl_Func *suite, void *data);
+
+/** Runs the benchmark function in a new test context.
+ * Same as cutl_run(), but the `func` function is called repeatedly and timed
+ * instead of being called once. The number of calls is first grown until they
+ * last long enough to be measured, then 10 samples of that many calls are
+ * timed, and their mean, median, standard deviation and minimum in nanoseconds
+ * per call are displayed as a #CUTL_INFO message of the benchmark.
+ *
+ * The function can fail the benchmark like any test, in which case nothing is
+ * displayed. It is called through a pointer, so that the few nanoseconds of
+ * the call are part of the measures. The `at_start` and `at_end` functions are
+ * only called once, around all of the calls.
+ *
+ * Benchmarks are never handed to a parallel job or thread, see cutl_set_jobs()
+ * and cutl_set_parallel(): they are run once the tests handed to them before
+ * are done. They fail when slower than their baseline, see
+ * cutl_set_baseline().
+ */
+CUTL_API int cutl_bench(
+	Cutl *cutl, const char *name, Cutl_Func *func, void *data);
+
 /** Runs the test function in a new test context.
  * Same as cutl_run(), with the `name` parameter automatically generated and the
  * `data` parameter set to NULL.
@@ -407,15 +978,15 @@ CUTL_API int cutl_run(
 	cutl_run((cutl), #func"('"#data"')", (Cutl_Func*) (func), (data))
 
 /** Runs the suite of tests in a new test context.
- * Same as cutl_run(), with the `name` parameter automatically generated and the
- * `data` parameter set to NULL.
+ * Same as cutl_run_as_suite(), with the `name` parameter automatically
+ * generated and the `data` parameter set to NULL.
  *
- * This macro is exactly the same as cutl_test(). Suites are indistinguishable
- * from regular tests when run, the only difference between tests and suites is
- * that suites also call cutl_run().
+ * When tests are run one after the other, suites are indistinguishable from
+ * regular tests, the only difference between tests and suites is that suites
+ * also call cutl_run().
  */
 #define cutl_suite(cutl, func)						\
-	cutl_run((cutl), #func, (Cutl_Func*) (func), NULL)
+	cutl_run_as_suite((cutl), #func, (Cutl_Func*) (func), NULL)
 
 /** Runs the test/suite anonymously.
  * Same as cutl_run(), with `name` and `data` parameter set to NULL.
@@ -424,6 +995,79 @@ CUTL_API int cutl_run(
 	cutl_run((cutl), NULL, (Cutl_Func*) (func), NULL)
 
 
+#ifdef CUTL_USE_SECTIONS
+/** Test registered at build time by CUTL_TEST() or CUTL_FIXTURE().
+ * Entries are kept in the `cutl_tests` section of the program, which the
+ * linker delimits with the `__start_cutl_tests` and `__stop_cutl_tests`
+ * symbols. Fixtures have no `name`, their `func` and `end` functions are
+ * those of cutl_at_start() and cutl_at_end().
+ */
+typedef struct {
+	const char *suite;
+	const char *name;
+	Cutl_Func *func;
+	Cutl_Func *end;
+	const char *file;
+	int line;
+} Cutl_Entry;
+
+/** Places a pointer to the entry in the `cutl_tests` section.
+ */
+#define CUTL_REGISTER(entry)						\
+	static const Cutl_Entry *const entry##_ptr			\
+	__attribute__((used, section("cutl_tests"))) = &entry;
+
+/** Defines a test function and registers it in the suite, so that it is run
+ * by cutl_run_registered() and listed by the `-l` option of
+ * cutl_parse_args(), without any call to cutl_run().
+ * Both `suite` and `name` must be identifiers, unique together. The macro is
+ * followed by the body of the test, whose parameters are `cutl` and `data`:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * CUTL_TEST(math, addition) {
+ *	cutl_assert_equal(cutl, 1 + 1, 2);
+ * }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Only available if #CUTL_USE_SECTIONS was defined at build time.
+ */
+#define CUTL_TEST(suite, name)						\
+	static void cutl_test_##suite##_##name(Cutl*, void*);		\
+	static const Cutl_Entry cutl_entry_##suite##_##name = {		\
+		#suite, #name, cutl_test_##suite##_##name, NULL,	\
+		__FILE__, __LINE__					\
+	};								\
+	CUTL_REGISTER(cutl_entry_##suite##_##name)			\
+	static void cutl_test_##suite##_##name(				\
+		Cutl *cutl, void *data __attribute__((unused)))
+
+/** Registers the `at_start` and `at_end` functions of the tests of the suite.
+ * Either function can be NULL. A suite has at most one fixture.
+ *
+ * Only available if #CUTL_USE_SECTIONS was defined at build time.
+ */
+#define CUTL_FIXTURE(suite, start, end)					\
+	static const Cutl_Entry cutl_fixture_##suite = {		\
+		#suite, NULL, (Cutl_Func*) (start), (Cutl_Func*) (end),	\
+		__FILE__, __LINE__					\
+	};								\
+	CUTL_REGISTER(cutl_fixture_##suite)
+#endif
+
+/** Runs the tests registered with CUTL_TEST(), without any call to
+ * cutl_run().
+ * Each suite is run with cutl_run_as_suite(), in the order of their names,
+ * and runs its tests in the order they are defined, with its fixture if any.
+ * The suites and tests run are the same whatever the order the program was
+ * linked in, so they can be planned before they are run, see the `-l` option
+ * of cutl_parse_args().
+ *
+ * Returns the number of failed tests, as cutl_run() does. If
+ * #CUTL_USE_SECTIONS was not defined at build time, then nothing is run and
+ * it returns `0`.
+ */
+CUTL_API int cutl_run_registered(Cutl *cutl);
+
+
 /** Interrupts the current test without marking it as failed.
  * Performs a longjmp() back to the parent call to cutl_run(). If the `cutl`
  * parameter is a top-level test context, then exit() is called instead,
@@ -543,11 +1187,75 @@ CUTL_API void cutl_check_at(
 
 /** Reports on the overall success of the test context.
  * Prints the total number of failed and passed test if the verbosity allows it.
+ * When sharding, see cutl_set_shard(), the shard is printed as well, so that
+ * the summaries of all the shards can be added up. The slowest tests are then
+ * listed, see cutl_set_slowest(), followed by the test with the largest heap
+ * peak, see cutl_set_leaks(). If set, the timings and baseline files are
+ * written as well, see cutl_set_timings() and cutl_set_baseline().
  * Returns the number of failed tests, exactly as cutl_get_failed() does.
  */
 CUTL_API int cutl_summary(Cutl *cutl);
 
 
+/** Identifies binary logs, see #CUTL_BINARY, in the first record.
+ */
+#define CUTL_LOG_MAGIC UINT64_C(0x31474f4c4c545543)
+
+/** Types of the records of binary logs.
+ */
+typedef enum {
+	/** First record of the log, with #CUTL_LOG_MAGIC as `name`, the size
+	 * of records as `size` and the time the log began.
+	 */
+	CUTL_LOG_BEGIN = 1,
+
+	/** String of `size` bytes, which follow the record, with `name` as id.
+	 * Strings are written before any record refers to their id, and may
+	 * be written again.
+	 */
+	CUTL_LOG_STRING = 2,
+
+	/** Test started, with its `name` and start `time`. */
+	CUTL_LOG_START = 3,
+
+	/** Message of a test, with its text as `name`, `file` and `line`, and
+	 * its #Cutl_VerbObj as `status`.
+	 */
+	CUTL_LOG_MESSAGE = 4,
+
+	/** Test ended, with its `name`, #Cutl_Log_Status, `duration` and
+	 * `cpu_duration`. Suites have a `size` of 1 and count their tests.
+	 */
+	CUTL_LOG_END = 5,
+
+	/** Summary of the whole run, with its #Cutl_Log_Status and counts. */
+	CUTL_LOG_SUMMARY = 6,
+} Cutl_Log_Type;
+
+/** Statuses of tests in binary logs.
+ */
+typedef enum {
+	CUTL_LOG_PASSED = 0,
+	CUTL_LOG_FAILED = 1,
+	CUTL_LOG_CANCELED = 2,
+} Cutl_Log_Status;
+
+/** Records of binary logs, written in the byte order of the machine.
+ * Every record has the `type`, `id`, `parent` id and `depth` of its test.
+ * String ids are hashes of their bytes, the empty string has id 0. Times are
+ * in seconds, from a clock that only makes sense within the log.
+ */
+typedef struct {
+	uint8_t type, status;
+	uint16_t depth;
+	int32_t id, parent, line;
+	int32_t passed, failed, skipped;
+	uint32_t size;
+	uint64_t name, file;
+	double time, duration, cpu_duration;
+} Cutl_Log_Record;
+
+
 
 /// \name MISCELLANEOUS
 
@@ -589,6 +1297,9 @@ CUTL_API void cutl_set_data(Cutl *cutl, void *data);
 /** Returns the number of children tests inside the current test context.
  * Recursively counts tests, but not suites and anonymous tests.
  *
+ * This function, as well as cutl_get_passed(), cutl_get_failed() and
+ * cutl_get_error(), first joins any children test still run by a parallel job.
+ *
  * By definition only suites have a number of children greater then zero.
  */
 CUTL_API int cutl_get_children(Cutl *cutl);
@@ -10,13 +10,58 @@
 #include <cutl_config.h>
 
 
-#ifdef CUTL_AUTO_COLOR_ENABLED
+#ifdef CUTL_USE_DL_ITERATE_PHDR
+# ifndef _GNU_SOURCE
+#  define _GNU_SOURCE
+# endif
+#endif
+
+#if defined(CUTL_USE_MMAP) || defined(CUTL_USE_PERF_EVENT)
+# ifndef _DEFAULT_SOURCE
+#  define _DEFAULT_SOURCE
+# endif
+#endif
+
+#if defined(CUTL_AUTO_COLOR_ENABLED) || defined(CUTL_USE_FORK) \
+	|| defined(CUTL_USE_PTHREAD) || defined(CUTL_USE_CLOCK_GETTIME) \
+	|| defined(CUTL_USE_SIGACTION) || defined(CUTL_USE_PERF_EVENT)
 # ifndef _POSIX_C_SOURCE
-#  define _POSIX_C_SOURCE 1
+#  define _POSIX_C_SOURCE 200809L
+# endif
+# if defined(CUTL_USE_SIGACTION) && !defined(_XOPEN_SOURCE)
+#  define _XOPEN_SOURCE 700
 # endif
 # include <unistd.h>
 #endif
 
+#ifdef CUTL_USE_FORK
+# include <sys/types.h>
+# include <sys/wait.h>
+#endif
+
+#ifdef CUTL_USE_MMAP
+# include <sys/mman.h>
+#endif
+
+#ifdef CUTL_USE_PTHREAD
+# include <pthread.h>
+#endif
+
+#ifdef CUTL_USE_SIGACTION
+# include <signal.h>
+#endif
+
+#ifdef CUTL_USE_DL_ITERATE_PHDR
+# include <elf.h>
+# include <link.h>
+#endif
+
+#ifdef CUTL_USE_PERF_EVENT
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+#endif
+
 
 
 // INCLUDES
@@ -25,9 +70,34 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
 #include <setjmp.h>
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
+#include <math.h>
+
+
+// Test programs are linked with `--wrap`, which also applies to the library
+// when it is linked statically: its own allocations are never accounted.
+#if defined(CUTL_HEAP_ENABLED) && !defined(CUTL_SHARED)
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+# define malloc __real_malloc
+# define calloc __real_calloc
+# define realloc __real_realloc
+# define free __real_free
+#endif
+
+
+// Bounds of the tests registered by the program, NULL if there is none.
+#ifdef CUTL_USE_SECTIONS
+extern const Cutl_Entry *const __start_cutl_tests[] __attribute__((weak));
+extern const Cutl_Entry *const __stop_cutl_tests[] __attribute__((weak));
+#endif
 
 
 
@@ -39,6 +109,36 @@
 
 #define CUTL_DEFAULT_OUTPUT stdout
 
+#define CUTL_DEFAULT_JOBS 1
+
+#define CUTL_DEFAULT_THREADS 1
+
+#define CUTL_DEFAULT_TIMEOUT 0
+
+#define CUTL_DEFAULT_REGRESSION 10
+
+#define CUTL_TIMEOUT_RETRY 0.1
+
+#define CUTL_TIMEOUT_GRACE 1.0
+
+#define CUTL_STACK_SIZE 65536
+
+#define CUTL_RING_SLOTS 64
+
+#define CUTL_SLOT_SIZE (1 << 20)
+
+#define CUTL_CHUNK_SIZE 4096
+
+#define CUTL_BENCH_TIME 0.01
+
+#define CUTL_BENCH_SAMPLES 10
+
+#define CUTL_BENCH_ALPHA 0.01
+
+#define CUTL_HASH_BASIS 2166136261u
+
+#define CUTL_HASH_PRIME 16777619u
+
 #define CUTL_PASS_COLOR "[0;32m"
 
 #define CUTL_FAIL_COLOR "[0;31m"
@@ -89,6 +189,44 @@ static void *cutl_calloc(size_t nmemb, size_t size)
 }
 
 
+static void *cutl_realloc(void *ptr, size_t size)
+{
+	ptr = realloc(ptr, size);
+	if (ptr == NULL && size > 0) {
+		perror("[ERROR cutl_realloc()] Memory allocation failed");
+		cutl_abort();
+	}
+	return ptr;
+}
+
+
+// Returns a time in seconds, only meaningful when compared to another one.
+static double cutl_time(void)
+{
+#ifdef CUTL_USE_CLOCK_GETTIME
+	struct timespec time;
+	if (clock_gettime(CLOCK_MONOTONIC, &time) == 0) {
+		return time.tv_sec + time.tv_nsec * 1e-9;
+	}
+#endif
+	return (double) clock() / CLOCKS_PER_SEC;
+}
+
+
+// Returns the processor time used by the calling thread, in seconds, or by
+// the whole process if it can't be told apart.
+static double cutl_cpu_time(void)
+{
+#ifdef CUTL_USE_CLOCK_GETTIME
+	struct timespec time;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0) {
+		return time.tv_sec + time.tv_nsec * 1e-9;
+	}
+#endif
+	return (double) clock() / CLOCKS_PER_SEC;
+}
+
+
 
 // UTILITY MACROS
 
@@ -106,16 +244,174 @@ typedef struct {
 	int verbosity;
 	int color;
 	const char *indent;
+	int jobs;
+	bool is_isolated;
+	int threads;
+	int shard_index, shard_count;
+	int timeout, cpu_timeout;
+	int guard;
+	int leaks;
+	int regression;
+	bool has_counters;
 } Cutl_Settings;
 
+typedef struct Cutl_Pool Cutl_Pool;
+
+typedef struct Cutl_Watchdog Cutl_Watchdog;
+
+typedef struct Cutl_Watch Cutl_Watch;
+
+typedef struct Cutl_Reporter Cutl_Reporter;
+
+typedef struct Cutl_Ring Cutl_Ring;
+
+typedef struct Cutl_Slot Cutl_Slot;
+
+typedef struct {
+	uintptr_t address;
+	size_t size;
+} Cutl_Block;
+
+typedef struct {
+	Cutl_Block *blocks;
+	size_t capacity;
+	size_t count, bytes, peak, nb_allocs;
+} Cutl_Heap;
+
+typedef struct {
+	uint32_t key;
+	int shard;
+	double duration;
+	char status;
+	uint32_t fingerprint;
+	int nb_functions;
+	uint32_t *functions;
+	int nb_samples;
+	double *samples;
+	char *name;
+} Cutl_Timing;
+
+typedef struct {
+	Cutl_Timing *items;
+	size_t size, capacity;
+} Cutl_Timings;
+
+typedef struct {
+	const char *pattern;
+	bool is_excluded;
+} Cutl_Filter;
+
+#ifdef CUTL_INCREMENTAL_ENABLED
+// Functions of the program and of its libraries, with the hash of their name,
+// sorted by address and by name.
+typedef struct {
+	uintptr_t start;
+	size_t size;
+	uint32_t name;
+} Cutl_Symbol;
+
+typedef struct {
+	Cutl_Symbol *by_address, *by_name;
+	size_t count, capacity;
+	bool is_loaded;
+} Cutl_Symbols;
+#endif
+
+#ifdef CUTL_USE_SECTIONS
+// Registered tests, sorted by suite then by position. Each suite is a range of
+// the entries.
+typedef struct {
+	const char *name;
+	const Cutl_Entry **entries;
+	size_t count;
+} Cutl_Registered;
+
+typedef struct {
+	const Cutl_Entry **entries;
+	Cutl_Registered *suites;
+	size_t nb_suites;
+} Cutl_Registry;
+#endif
+
 typedef struct {
 	int last_id;
+	int nb_workers;
+	bool is_worker, is_server;
+	Cutl_Pool *pool;
+	const char *timings_path;
+	Cutl_Timings history, measured;
+	int plan_count;
+	const char *baseline_path;
+	Cutl_Timings baseline, benched;
+	const char *cache_path;
+	char *default_cache_path;
+	Cutl_Timings cache, results;
+	bool is_failed_first, is_incremental;
+	int slowest_count;
+	Cutl_Timings slowest;
+	size_t heap_peak;
+	char *heap_peak_name;
+	Cutl_Watchdog *watchdog;
+	Cutl_Ring *ring;
+	bool is_async;
+	Cutl_Reporter *reporter;
+	Cutl_Filter *filters;
+	size_t nb_filters;
+#ifdef CUTL_USE_SECTIONS
+	Cutl_Registry registry;
+#endif
+#ifdef CUTL_INCREMENTAL_ENABLED
+	Cutl_Symbols symbols;
+#endif
+#ifdef CUTL_USE_PTHREAD
+	pthread_mutex_t lock;
+#endif
 } Cutl_Globals;
 
+typedef struct Cutl_Job Cutl_Job;
+
+typedef struct Cutl_Chunk Cutl_Chunk;
+
+typedef struct {
+	char *data;
+	size_t size, capacity;
+} Cutl_Buffer;
+
+// Strings already written to a binary log, as an open addressing set of
+// their ids.
+typedef struct {
+	uint64_t *ids;
+	size_t count, capacity;
+} Cutl_Strings;
+
+// Functions entered by a test, as an open addressing set of their addresses.
+typedef struct {
+	uintptr_t *functions;
+	size_t count, capacity;
+} Cutl_Coverage;
+
+// Reports of each format can be written at the same time.
+enum { CUTL_NB_REPORTS = 4 };
+
+typedef enum {
+	CUTL_KIND_TEST,
+	CUTL_KIND_SUITE,
+	CUTL_KIND_SERVER,
+	CUTL_KIND_BENCH,
+} Cutl_Kind;
+
+typedef struct {
+	Cutl_Func *test;
+	Cutl_Func *start, *end;
+	void *start_data, *end_data;
+	bool is_bench;
+} Cutl_Task;
+
 struct Cutl {
 	const char * const name;
 	const int id;
 	const int depth;
+	const uint32_t key;
 	Cutl * const parent;
 	Cutl_Globals * const globals;
 
@@ -140,9 +436,39 @@ struct Cutl {
 	} stage;
 
 	bool failed, error;
-	int nb_children, nb_passed, nb_failed;
-	bool is_prefixed, is_infixed;
+	int nb_children, nb_passed, nb_failed, nb_skipped;
+	bool is_prefixed, is_infixed, is_reported;
+	int nb_reported;
+	bool is_suite, is_unit, is_server, is_detached, is_threaded;
+	double started, duration, cpu_duration;
+	int timed_out, crashed;
+	Cutl_Watch *watch;
+	Cutl_Heap heap;
 	bool has_color;
+
+	Cutl_Job *first_job, *last_job;
+	Cutl_Chunk *arena;
+	Cutl_Buffer line, records;
+	FILE *reports[CUTL_NB_REPORTS];
+	Cutl_Strings strings;
+	Cutl_Coverage coverage;
+	int worker;
+};
+
+struct Cutl_Job {
+	Cutl cutl;
+	Cutl_Task task;
+	Cutl_Job *next, *prev_task, *next_task;
+	FILE *output, *reports[CUTL_NB_REPORTS];
+	char *buffer, *report_buffers[CUTL_NB_REPORTS];
+	size_t size, report_sizes[CUTL_NB_REPORTS];
+	Cutl_Buffer coverage;
+#ifdef CUTL_USE_FORK
+	pid_t pid;
+#endif
+	Cutl_Slot *slot;
+	int status;
+	bool is_forked, is_done;
 };
 
 
@@ -156,29 +482,207 @@ Cutl *cutl_new(const char *name)
 	Cutl *cutl = cutl_malloc(sizeof(*cutl));
 	Cutl_Globals *globals = cutl_calloc(1, sizeof(*globals));
 
-	Cutl _cutl = {.name = name, .globals = globals};
+	Cutl _cutl = {
+		.name = name, .key = CUTL_HASH_BASIS, .globals = globals
+	};
 	memcpy(cutl, &_cutl, sizeof(_cutl));
 
+#ifdef CUTL_USE_PTHREAD
+	pthread_mutex_init(&globals->lock, NULL);
+#endif
+
 	cutl_set_output(cutl, NULL);
+	cutl_set_async(cutl, false);
 	cutl_set_verbosity(cutl, -1);
 	cutl_set_color(cutl, -1);
 	cutl_set_indent(cutl, NULL);
+	cutl_set_jobs(cutl, -1);
+	cutl_set_isolated(cutl, false);
+	cutl_set_parallel(cutl, -1);
+	cutl_set_regression(cutl, -1);
+	cutl_set_counters(cutl, false);
+	cutl_set_shard(cutl, 0, 0);
+	cutl_set_timeout(cutl, -1);
+	cutl_set_cpu_timeout(cutl, -1);
+	cutl_set_guard(cutl, 0);
+	cutl_set_leaks(cutl, 0);
 
 	return cutl;
 }
 
 
+static void cutl_join(Cutl *cutl);
+
+#ifdef CUTL_USE_FORK
+static void cutl_join_done(Cutl *parent);
+#endif
+
+static void cutl_timings_read(Cutl_Globals *globals, const char *path);
+
+static void cutl_baseline_read(Cutl_Globals *globals, const char *path);
+
+static void cutl_cache_read(Cutl_Globals *globals, const char *path);
+
+static void cutl_timings_free(Cutl_Timings *timings);
+
+static void cutl_timing_free(Cutl_Timing *timing);
+
+#ifdef CUTL_INCREMENTAL_ENABLED
+static void cutl_coverage_fingerprint(const Cutl *cutl, Cutl_Timing *timing);
+#endif
+
+static void cutl_lock(Cutl_Globals *globals);
+
+static void cutl_unlock(Cutl_Globals *globals);
+
+#ifdef CUTL_USE_PTHREAD
+static void cutl_pool_free(Cutl_Pool *pool);
+#endif
+
+#ifdef CUTL_TIMEOUT_ENABLED
+static void cutl_watchdog_free(Cutl_Watchdog *watchdog);
+
+static void cutl_timeout_update(Cutl *cutl);
+#endif
+
+#ifdef CUTL_USE_MMAP
+static void cutl_ring_free(Cutl_Ring *ring);
+#endif
+
+#ifdef CUTL_USE_PTHREAD
+static void cutl_reporter_free(Cutl_Reporter *reporter);
+#endif
+
+static void cutl_arena_free(Cutl *cutl);
+
+static void cutl_report_end(Cutl *cutl);
+
 void cutl_free(Cutl *cutl)
 {
 	assert(cutl != NULL);
 	assert(cutl->id == 0);
 
+	cutl_join(cutl);
+	cutl_report_end(cutl);
+#ifdef CUTL_USE_PTHREAD
+	cutl_reporter_free(cutl->globals->reporter);
+#endif
+
+	cutl_timings_free(&cutl->globals->history);
+	cutl_timings_free(&cutl->globals->measured);
+	cutl_timings_free(&cutl->globals->baseline);
+	cutl_timings_free(&cutl->globals->benched);
+	cutl_timings_free(&cutl->globals->cache);
+	cutl_timings_free(&cutl->globals->results);
+	free(cutl->globals->default_cache_path);
+	cutl_timings_free(&cutl->globals->slowest);
+	free(cutl->globals->heap_peak_name);
+	free(cutl->globals->filters);
+#ifdef CUTL_USE_SECTIONS
+	free(cutl->globals->registry.entries);
+	free(cutl->globals->registry.suites);
+#endif
+#ifdef CUTL_INCREMENTAL_ENABLED
+	free(cutl->globals->symbols.by_address);
+	free(cutl->globals->symbols.by_name);
+#endif
+#ifdef CUTL_TIMEOUT_ENABLED
+	cutl_watchdog_free(cutl->globals->watchdog);
+#endif
+#ifdef CUTL_USE_MMAP
+	cutl_ring_free(cutl->globals->ring);
+#endif
+#ifdef CUTL_USE_PTHREAD
+	cutl_pool_free(cutl->globals->pool);
+	pthread_mutex_destroy(&cutl->globals->lock);
+#endif
+	cutl_arena_free(cutl);
+	free(cutl->line.data);
 	free(cutl->globals);
 	memset(cutl, 0, sizeof(*cutl));
 	free(cutl);
 }
 
 
+// Blocks are aligned for any type, as with malloc().
+typedef union {
+	long double d;
+	long long l;
+	void *p;
+	void (*f)(void);
+} Cutl_Align;
+
+struct Cutl_Chunk {
+	Cutl_Chunk *next;
+	size_t size, used;
+	Cutl_Align data[];
+};
+
+enum {
+	CUTL_CHUNK_UNITS = CUTL_CHUNK_SIZE / sizeof(Cutl_Align),
+	CUTL_CHUNK_HEADER = (sizeof(Cutl_Chunk) + sizeof(Cutl_Align) - 1)
+		/ sizeof(Cutl_Align),
+};
+
+
+void *cutl_alloc(Cutl *cutl, size_t size)
+{
+	assert(cutl != NULL);
+
+	// Never interrupted while the arena is changed.
+	const int stage = cutl->stage;
+	cutl->stage = 0;
+
+	size_t units = size / sizeof(Cutl_Align);
+	if (size % sizeof(Cutl_Align) != 0 || units == 0) units++;
+
+	Cutl_Chunk *chunk = cutl->arena;
+	if (chunk == NULL || chunk->size - chunk->used < units) {
+		const size_t capacity = units > CUTL_CHUNK_UNITS ? units
+			: CUTL_CHUNK_UNITS;
+		chunk = cutl_calloc(
+			CUTL_CHUNK_HEADER + capacity, sizeof(Cutl_Align)
+		);
+		chunk->size = capacity;
+
+		// Large blocks get a chunk of their own, so that the room
+		// left in the current one can still be used.
+		if (cutl->arena != NULL && capacity > CUTL_CHUNK_UNITS) {
+			chunk->next = cutl->arena->next;
+			cutl->arena->next = chunk;
+		} else {
+			chunk->next = cutl->arena;
+			cutl->arena = chunk;
+		}
+	}
+
+	void *ptr = &chunk->data[chunk->used];
+	chunk->used += units;
+
+	cutl->stage = stage;
+	return ptr;
+}
+
+
+char *cutl_strdup(Cutl *cutl, const char *str)
+{
+	assert(str != NULL);
+
+	const size_t size = strlen(str) + 1;
+	return memcpy(cutl_alloc(cutl, size), str, size);
+}
+
+
+static void cutl_arena_free(Cutl *cutl)
+{
+	while (cutl->arena != NULL) {
+		Cutl_Chunk *next = cutl->arena->next;
+		free(cutl->arena);
+		cutl->arena = next;
+	}
+}
+
+
 
 // SETTINGS
 
@@ -198,6 +702,72 @@ FILE *cutl_get_output(const Cutl *cutl)
 }
 
 
+static void cutl_drain(Cutl *cutl);
+
+void cutl_set_async(Cutl *cutl, bool is_async)
+{
+	assert(cutl != NULL);
+
+	// Lines still queued are written before the following ones.
+	if (!is_async) cutl_drain(cutl);
+	cutl->globals->is_async = is_async;
+}
+
+bool cutl_get_async(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->globals->is_async;
+}
+
+
+static Cutl *cutl_get_root(const Cutl *cutl)
+{
+	while (cutl->parent != NULL) {
+		cutl = cutl->parent;
+	}
+	return (Cutl*) cutl;
+}
+
+
+static int cutl_writer_find(int format);
+
+static int cutl_report_formats(const Cutl *root);
+
+static void cutl_report_set(Cutl *root, int index, FILE *report);
+
+static int cutl_report_parse(const char *arg, const char **path);
+
+void cutl_set_report(Cutl *cutl, int format, FILE *report)
+{
+	assert(cutl != NULL);
+
+	Cutl *root = cutl_get_root(cutl);
+	if (format == CUTL_NO_REPORT) {
+		cutl_report_end(root);
+		return;
+	}
+
+	const int index = cutl_writer_find(format);
+	if (index >= 0) cutl_report_set(root, index, report);
+}
+
+FILE *cutl_get_report(const Cutl *cutl, int format)
+{
+	assert(cutl != NULL);
+
+	const int index = cutl_writer_find(format);
+	return index >= 0 ? cutl_get_root(cutl)->reports[index] : NULL;
+}
+
+int cutl_get_report_format(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl_report_formats(cutl_get_root(cutl));
+}
+
+
 void cutl_set_verbosity(Cutl *cutl, int verbosity)
 {
 	assert(cutl != NULL);
@@ -251,54 +821,357 @@ const char *cutl_get_indent(const Cutl *cutl)
 }
 
 
+void cutl_set_jobs(Cutl *cutl, int jobs)
+{
+	assert(cutl != NULL);
 
-// ARGUMENT PARSING
+	cutl->settings.jobs = jobs >= 1 ? jobs : CUTL_DEFAULT_JOBS;
+}
 
-typedef struct {
-	Cutl * const cutl;
-	char * const * const argv;
-	const int argc;
-	size_t optind;
-	const char *opt;
-} Cutl_Parser;
+int cutl_get_jobs(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->settings.jobs;
+}
 
 
-static inline bool cutl_parser_isopt(Cutl_Parser *parser, size_t i)
+void cutl_set_isolated(Cutl *cutl, bool is_isolated)
 {
-	return i < parser->argc && parser->argv[i] != NULL
-		&& parser->argv[i][0] == '-' && isalnum(parser->argv[i][1]);
-}
+	assert(cutl != NULL);
 
+	cutl->settings.is_isolated = is_isolated;
+}
 
-static inline bool cutl_parser_isarg(Cutl_Parser *parser, size_t i)
+bool cutl_get_isolated(const Cutl *cutl)
 {
-	return i < parser->argc && parser->argv[i] != NULL
-		&& (parser->argv[i][0] != '-' || !isalnum(parser->argv[i][1]));
+	assert(cutl != NULL);
+
+	return cutl->settings.is_isolated;
 }
 
 
-static int cutl_parser_getopt(Cutl_Parser *parser)
+void cutl_set_parallel(Cutl *cutl, int threads)
 {
-	// Next option in current argument string.
-	if (parser->opt != NULL && parser->opt[1] != '\0') {
-		parser->opt++;
-		return *parser->opt;
-	}
+	assert(cutl != NULL);
 
-	// First option in next argument string.
-	if (cutl_parser_isopt(parser, ++parser->optind)) {
-		parser->opt = parser->argv[parser->optind] + 1;
-		return *parser->opt;
-	}
+	cutl->settings.threads = threads >= 1 ? threads : CUTL_DEFAULT_THREADS;
+}
 
-	// No more options.
-	return -1;
+int cutl_get_parallel(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->settings.threads;
 }
 
 
-static const char *cutl_parser_getarg(Cutl_Parser *parser, bool is_required)
+void cutl_set_shard(Cutl *cutl, int index, int count)
 {
-	// Return the end of the current argument string.
+	assert(cutl != NULL);
+
+	if (count < 2 || index < 1 || index > count) {
+		index = count = 1;
+	}
+	cutl->settings.shard_index = index;
+	cutl->settings.shard_count = count;
+}
+
+int cutl_get_shard(const Cutl *cutl, int *count)
+{
+	assert(cutl != NULL);
+
+	if (count != NULL) {
+		*count = cutl->settings.shard_count;
+	}
+	return cutl->settings.shard_index;
+}
+
+
+void cutl_add_filter(Cutl *cutl, const char *pattern, bool is_excluded)
+{
+	assert(cutl != NULL);
+
+	Cutl_Globals *globals = cutl->globals;
+	if (pattern == NULL) {
+		free(globals->filters);
+		globals->filters = NULL;
+		globals->nb_filters = 0;
+		return;
+	}
+
+	globals->filters = cutl_realloc(
+		globals->filters,
+		(globals->nb_filters + 1) * sizeof(*globals->filters)
+	);
+	globals->filters[globals->nb_filters++] = (Cutl_Filter) {
+		.pattern = pattern, .is_excluded = is_excluded
+	};
+}
+
+const char *cutl_get_filter(const Cutl *cutl, int index, bool *is_excluded)
+{
+	assert(cutl != NULL);
+
+	const Cutl_Globals *globals = cutl->globals;
+	if (index < 0 || (size_t) index >= globals->nb_filters) return NULL;
+
+	if (is_excluded != NULL) {
+		*is_excluded = globals->filters[index].is_excluded;
+	}
+	return globals->filters[index].pattern;
+}
+
+
+void cutl_set_timeout(Cutl *cutl, int timeout)
+{
+	assert(cutl != NULL);
+
+	cutl->settings.timeout = timeout > 0 ? timeout : CUTL_DEFAULT_TIMEOUT;
+#ifdef CUTL_TIMEOUT_ENABLED
+	if (cutl->watch != NULL) cutl_timeout_update(cutl);
+#endif
+}
+
+int cutl_get_timeout(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->settings.timeout;
+}
+
+
+void cutl_set_cpu_timeout(Cutl *cutl, int timeout)
+{
+	assert(cutl != NULL);
+
+	cutl->settings.cpu_timeout = timeout > 0
+		? timeout : CUTL_DEFAULT_TIMEOUT;
+#ifdef CUTL_TIMEOUT_ENABLED
+	if (cutl->watch != NULL) cutl_timeout_update(cutl);
+#endif
+}
+
+int cutl_get_cpu_timeout(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->settings.cpu_timeout;
+}
+
+
+void cutl_set_guard(Cutl *cutl, int type)
+{
+	assert(cutl != NULL);
+
+	cutl->settings.guard = (type == CUTL_FAIL || type == CUTL_ERROR)
+		? type : 0;
+}
+
+int cutl_get_guard(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->settings.guard;
+}
+
+
+void cutl_set_leaks(Cutl *cutl, int type)
+{
+	assert(cutl != NULL);
+
+	cutl->settings.leaks = (
+		type == CUTL_WARN || type == CUTL_FAIL || type == CUTL_ERROR
+	) ? type : 0;
+}
+
+int cutl_get_leaks(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->settings.leaks;
+}
+
+
+void cutl_set_timings(Cutl *cutl, const char *path)
+{
+	assert(cutl != NULL);
+
+	cutl->globals->timings_path = path;
+	cutl_timings_read(cutl->globals, path);
+}
+
+const char *cutl_get_timings(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->globals->timings_path;
+}
+
+
+void cutl_set_baseline(Cutl *cutl, const char *path)
+{
+	assert(cutl != NULL);
+
+	cutl->globals->baseline_path = path;
+	cutl_baseline_read(cutl->globals, path);
+}
+
+const char *cutl_get_baseline(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->globals->baseline_path;
+}
+
+
+void cutl_set_cache(Cutl *cutl, const char *path)
+{
+	assert(cutl != NULL);
+
+	cutl->globals->cache_path = path;
+	cutl_cache_read(cutl->globals, path);
+}
+
+const char *cutl_get_cache(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->globals->cache_path;
+}
+
+
+void cutl_set_failed_first(Cutl *cutl, bool is_failed_first)
+{
+	assert(cutl != NULL);
+
+	cutl->globals->is_failed_first = is_failed_first;
+}
+
+bool cutl_get_failed_first(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->globals->is_failed_first;
+}
+
+
+void cutl_set_incremental(Cutl *cutl, bool is_incremental)
+{
+	assert(cutl != NULL);
+
+	cutl->globals->is_incremental = is_incremental;
+}
+
+bool cutl_get_incremental(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->globals->is_incremental;
+}
+
+
+void cutl_set_slowest(Cutl *cutl, int count)
+{
+	assert(cutl != NULL);
+
+	Cutl_Globals *globals = cutl->globals;
+	cutl_lock(globals);
+	globals->slowest_count = count > 0 ? count : 0;
+	Cutl_Timings *slowest = &globals->slowest;
+	while (slowest->size > (size_t) globals->slowest_count) {
+		cutl_timing_free(&slowest->items[--slowest->size]);
+	}
+	cutl_unlock(globals);
+}
+
+int cutl_get_slowest(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->globals->slowest_count;
+}
+
+
+void cutl_set_regression(Cutl *cutl, int percent)
+{
+	assert(cutl != NULL);
+
+	cutl->settings.regression = percent >= 0
+		? percent : CUTL_DEFAULT_REGRESSION;
+}
+
+int cutl_get_regression(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->settings.regression;
+}
+
+
+void cutl_set_counters(Cutl *cutl, bool has_counters)
+{
+	assert(cutl != NULL);
+
+	cutl->settings.has_counters = has_counters;
+}
+
+bool cutl_get_counters(const Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	return cutl->settings.has_counters;
+}
+
+
+
+// ARGUMENT PARSING
+
+typedef struct {
+	Cutl * const cutl;
+	char * const * const argv;
+	const int argc;
+	size_t optind;
+	const char *opt;
+} Cutl_Parser;
+
+
+static inline bool cutl_parser_isopt(Cutl_Parser *parser, size_t i)
+{
+	return i < parser->argc && parser->argv[i] != NULL
+		&& parser->argv[i][0] == '-' && isalnum(parser->argv[i][1]);
+}
+
+
+static inline bool cutl_parser_isarg(Cutl_Parser *parser, size_t i)
+{
+	return i < parser->argc && parser->argv[i] != NULL
+		&& (parser->argv[i][0] != '-' || !isalnum(parser->argv[i][1]));
+}
+
+
+static int cutl_parser_getopt(Cutl_Parser *parser)
+{
+	// Next option in current argument string.
+	if (parser->opt != NULL && parser->opt[1] != '\0') {
+		parser->opt++;
+		return *parser->opt;
+	}
+
+	// First option in next argument string.
+	if (cutl_parser_isopt(parser, ++parser->optind)) {
+		parser->opt = parser->argv[parser->optind] + 1;
+		return *parser->opt;
+	}
+
+	// No more options.
+	return -1;
+}
+
+
+static const char *cutl_parser_getarg(Cutl_Parser *parser, bool is_required)
+{
+	// Return the end of the current argument string.
 	if (parser->opt != NULL && parser->opt[1] != '\0') {
 		const char *arg = parser->opt + 1;
 		parser->opt = NULL;
@@ -322,6 +1195,8 @@ static const char *cutl_parser_getarg(Cutl_Parser *parser, bool is_required)
 }
 
 
+static void cutl_registry_list(Cutl *cutl);
+
 void cutl_parse_args(Cutl *cutl, int argc, char * const argv[])
 {
 	assert(cutl != NULL);
@@ -338,6 +1213,32 @@ void cutl_parse_args(Cutl *cutl, int argc, char * const argv[])
 	int verbosity = cutl->settings.verbosity;
 	int color = cutl->settings.color;
 	FILE *output = cutl->settings.output;
+	bool is_async = cutl->globals->is_async;
+	FILE *reports[CUTL_NB_REPORTS] = {NULL};
+	int index;
+	Cutl_Filter filters[argc];
+	int nb_filters = 0;
+	int jobs = cutl->settings.jobs;
+	bool is_isolated = cutl->settings.is_isolated;
+	int shard_index = cutl->settings.shard_index;
+	int shard_count = cutl->settings.shard_count;
+	const char *timings = cutl->globals->timings_path;
+	const char *cache = cutl->globals->cache_path;
+	bool is_failed_first = cutl->globals->is_failed_first;
+	bool is_incremental = cutl->globals->is_incremental;
+	int timeout = cutl->settings.timeout;
+	int cpu_timeout = cutl->settings.cpu_timeout;
+	int *limit;
+	const char *value;
+	int guard = cutl->settings.guard;
+	int leaks = cutl->settings.leaks;
+	const char *baseline = cutl->globals->baseline_path;
+	int regression = cutl->settings.regression;
+	bool has_counters = cutl->settings.has_counters;
+	int slowest = cutl->globals->slowest_count;
+	bool is_listing = false;
+	const char *path;
+	char *end;
 
 	while ((opt = cutl_parser_getopt(&parser)) != -1) {
 		switch (opt) {
@@ -347,6 +1248,23 @@ void cutl_parse_args(Cutl *cutl, int argc, char * const argv[])
 			verbosity = CUTL_MINIMAL; break;
 		case 's':
 			verbosity = CUTL_SILENT; break;
+		case 'a':
+			is_async = true; break;
+		case 'i':
+			is_isolated = true; break;
+		case 'p':
+			has_counters = true; break;
+		case 'l':
+			is_listing = true; break;
+		case 'f':
+		case 'F':
+			optarg = cutl_parser_getarg(&parser, true);
+			if (optarg == NULL) return;
+
+			filters[nb_filters++] = (Cutl_Filter) {
+				.pattern = optarg, .is_excluded = opt == 'F'
+			};
+			break;
 		case 'c':
 			optarg = cutl_parser_getarg(&parser, true);
 			if (optarg == NULL) return;
@@ -366,6 +1284,42 @@ void cutl_parse_args(Cutl *cutl, int argc, char * const argv[])
 				return;
 			}
 			break;
+		case 'g':
+			optarg = cutl_parser_getarg(&parser, true);
+			if (optarg == NULL) return;
+
+			if (strcmp(optarg, "fail") == 0) {
+				guard = CUTL_FAIL;
+			} else if (strcmp(optarg, "error") == 0) {
+				guard = CUTL_ERROR;
+			} else {
+				cutl_message_at(
+					cutl, CUTL_ERROR, "cutl_parse_args()",
+					0, "Invalid argument for option 'g': "
+					"'%s'.", optarg
+				);
+				return;
+			}
+			break;
+		case 'L':
+			optarg = cutl_parser_getarg(&parser, true);
+			if (optarg == NULL) return;
+
+			if (strcmp(optarg, "warn") == 0) {
+				leaks = CUTL_WARN;
+			} else if (strcmp(optarg, "fail") == 0) {
+				leaks = CUTL_FAIL;
+			} else if (strcmp(optarg, "error") == 0) {
+				leaks = CUTL_ERROR;
+			} else {
+				cutl_message_at(
+					cutl, CUTL_ERROR, "cutl_parse_args()",
+					0, "Invalid argument for option 'L': "
+					"'%s'.", optarg
+				);
+				return;
+			}
+			break;
 		case 'o':
 			optarg = cutl_parser_getarg(&parser, true);
 			if (optarg == NULL) return;
@@ -379,43 +1333,495 @@ void cutl_parse_args(Cutl *cutl, int argc, char * const argv[])
 				optarg, strerror(errno)
 			);
 			return;
-		case 'h':
-			printf("Usage: %s [options]\n", argv[0]);
-			printf("Options:\n");
-			printf("  -v               Verbose output.\n");
-			printf("  -m               Minimal output.\n");
-			printf("  -s               Silent output.\n");
-			printf("  -c <auto|on|off> Colored output.\n");
-			printf("  -o <file>        Output file.\n");
-			printf("  -h               Print this message and exit.\n");
-			printf("CUTL version: %s\n", CUTL_VERSION);
-			cutl_interrupt(cutl);
-		default:
-			cutl_message_at(
-				cutl, CUTL_ERROR, "cutl_parse_args()", 0,
-				"Invalid option: '%c'.", *parser.opt
-			);
-			return;
+		case 'R':
+			optarg = cutl_parser_getarg(&parser, true);
+			if (optarg == NULL) return;
+
+			index = cutl_report_parse(optarg, &path);
+			if (index < 0) {
+				cutl_message_at(
+					cutl, CUTL_ERROR, "cutl_parse_args()",
+					0, "Invalid argument for option 'R': "
+					"'%s'.", optarg
+				);
+				return;
+			}
+
+			if (reports[index] != NULL) fclose(reports[index]);
+			reports[index] = fopen(path, "wb");
+			if (reports[index] != NULL) break;
+
+			cutl_message_at(
+				cutl, CUTL_ERROR, "cutl_parse_args()", 0,
+				"Could not open report file '%s' (%s).",
+				path, strerror(errno)
+			);
+			return;
+		case 'j':
+			optarg = cutl_parser_getarg(&parser, true);
+			if (optarg == NULL) return;
+
+			jobs = strtol(optarg, &end, 10);
+			if (*end == '\0' && end != optarg && jobs >= 1) break;
+
+			cutl_message_at(
+				cutl, CUTL_ERROR, "cutl_parse_args()", 0,
+				"Invalid argument for option 'j': '%s'.", optarg
+			);
+			return;
+		case 'S':
+			optarg = cutl_parser_getarg(&parser, true);
+			if (optarg == NULL) return;
+
+			shard_index = strtol(optarg, &end, 10);
+			if (*end == '/' && end != optarg) {
+				const char *count = end + 1;
+				shard_count = strtol(count, &end, 10);
+			}
+			if (*end == '\0' && shard_index >= 1
+				&& shard_index <= shard_count) break;
+
+			cutl_message_at(
+				cutl, CUTL_ERROR, "cutl_parse_args()", 0,
+				"Invalid argument for option 'S': '%s'.", optarg
+			);
+			return;
+		case 't':
+			optarg = cutl_parser_getarg(&parser, true);
+			if (optarg == NULL) return;
+
+			limit = &timeout;
+			value = optarg;
+			if (strncmp(optarg, "cpu:", 4) == 0) {
+				limit = &cpu_timeout;
+				value = optarg + 4;
+			}
+			*limit = strtol(value, &end, 10);
+			if (*end == '\0' && end != value && *limit >= 0) {
+				break;
+			}
+
+			cutl_message_at(
+				cutl, CUTL_ERROR, "cutl_parse_args()", 0,
+				"Invalid argument for option 't': '%s'.", optarg
+			);
+			return;
+		case 'T':
+			timings = cutl_parser_getarg(&parser, true);
+			if (timings == NULL) return;
+			break;
+		case 'C':
+			cache = cutl_parser_getarg(&parser, true);
+			if (cache == NULL) return;
+			break;
+		case 'n':
+			is_failed_first = true; break;
+		case 'u':
+			is_incremental = true; break;
+		case 'd':
+			optarg = cutl_parser_getarg(&parser, true);
+			if (optarg == NULL) return;
+
+			slowest = strtol(optarg, &end, 10);
+			if (*end == '\0' && end != optarg && slowest >= 0) {
+				break;
+			}
+
+			cutl_message_at(
+				cutl, CUTL_ERROR, "cutl_parse_args()", 0,
+				"Invalid argument for option 'd': '%s'.", optarg
+			);
+			return;
+		case 'b':
+			baseline = cutl_parser_getarg(&parser, true);
+			if (baseline == NULL) return;
+			break;
+		case 'r':
+			optarg = cutl_parser_getarg(&parser, true);
+			if (optarg == NULL) return;
+
+			regression = strtol(optarg, &end, 10);
+			if (*end == '\0' && end != optarg && regression >= 0) {
+				break;
+			}
+
+			cutl_message_at(
+				cutl, CUTL_ERROR, "cutl_parse_args()", 0,
+				"Invalid argument for option 'r': '%s'.", optarg
+			);
+			return;
+		case 'h':
+			printf("Usage: %s [options]\n", argv[0]);
+			printf("Options:\n");
+			printf("  -v               Verbose output.\n");
+			printf("  -m               Minimal output.\n");
+			printf("  -s               Silent output.\n");
+			printf("  -c <auto|on|off> Colored output.\n");
+			printf("  -o <file>        Output file.\n");
+			printf("  -a               Asynchronous output.\n");
+			printf("  -R <fmt:file>    Report "
+				"(junit|tap|json|bin).\n");
+			printf("  -j <jobs>        Number of parallel jobs.\n");
+			printf("  -i               Run each test in a job.\n");
+			printf("  -S <index/count> Shard of tests to run.\n");
+			printf("  -f <pattern>     Run matching tests.\n");
+			printf("  -F <pattern>     Skip matching tests.\n");
+			printf("  -T <file>        Timings file.\n");
+			printf("  -C <file>        Results cache file.\n");
+			printf("  -n               Run failed tests first.\n");
+			printf("  -u               Skip unchanged tests.\n");
+			printf("  -d <count>       Slowest tests to list.\n");
+			printf("  -t [cpu:]<ms>    Timeout of tests.\n");
+			printf("  -g <fail|error>  Guard against crashes.\n");
+			printf("  -L <level>       Report memory leaks.\n");
+			printf("  -b <file>        Benchmark baseline file.\n");
+			printf("  -r <percent>     Regression threshold.\n");
+			printf("  -p               Count benchmark events.\n");
+			printf("  -l               List tests and exit.\n");
+			printf("  -h               Print this message and exit.\n");
+			printf("CUTL version: %s\n", CUTL_VERSION);
+			cutl_interrupt(cutl);
+		default:
+			cutl_message_at(
+				cutl, CUTL_ERROR, "cutl_parse_args()", 0,
+				"Invalid option: '%c'.", *parser.opt
+			);
+			return;
 		}
 	}
 
 	cutl_set_output(cutl, output);
+	cutl_set_async(cutl, is_async);
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		if (reports[i] != NULL) {
+			cutl_report_set(cutl_get_root(cutl), i, reports[i]);
+		}
+	}
 	cutl_set_color(cutl, color);
 	cutl_set_verbosity(cutl, verbosity);
+	cutl_set_jobs(cutl, jobs);
+	cutl_set_isolated(cutl, is_isolated);
+	cutl_set_shard(cutl, shard_index, shard_count);
+	for (int i=0; i<nb_filters; ++i) {
+		cutl_add_filter(
+			cutl, filters[i].pattern, filters[i].is_excluded
+		);
+	}
+	cutl_set_timeout(cutl, timeout);
+	cutl_set_cpu_timeout(cutl, cpu_timeout);
+	cutl_set_guard(cutl, guard);
+	cutl_set_leaks(cutl, leaks);
+	cutl_set_regression(cutl, regression);
+	cutl_set_counters(cutl, has_counters);
+	cutl_set_slowest(cutl, slowest);
+	if (timings != cutl->globals->timings_path) {
+		cutl_set_timings(cutl, timings);
+	}
+	if (baseline != cutl->globals->baseline_path) {
+		cutl_set_baseline(cutl, baseline);
+	}
+
+	// Results are cached next to the program by default.
+	Cutl_Globals *globals = cutl->globals;
+	if ((is_failed_first || is_incremental) && cache == NULL) {
+		free(globals->default_cache_path);
+		globals->default_cache_path = cutl_malloc(strlen(argv[0]) + 7);
+		sprintf(globals->default_cache_path, "%s.cache", argv[0]);
+		cache = globals->default_cache_path;
+	}
+	if (cache != globals->cache_path) {
+		cutl_set_cache(cutl, cache);
+	}
+	cutl_set_failed_first(cutl, is_failed_first);
+	cutl_set_incremental(cutl, is_incremental);
+
+	// Tests are listed once the shard and its timings are known.
+	if (is_listing) {
+		cutl_registry_list(cutl);
+		cutl_interrupt(cutl);
+	}
+}
+
+
+
+// ASYNCHRONOUS OUTPUT
+
+#ifdef CUTL_USE_PTHREAD
+
+#define CUTL_REPORTER_SIZE ((size_t) 1 << 16)
+
+// Lines are queued by the thread that started the tests and written by the
+// reporter thread, through a ring of bytes: `tail` is only moved forward by
+// the former, `head` by the latter. Either of them only takes the lock to
+// sleep, or to wake the other one up.
+struct Cutl_Reporter {
+	FILE *output;
+	char *data;
+	size_t head, tail;
+	bool is_sleeping, is_waiting, is_stopping;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t thread;
+};
+
+
+static void cutl_reporter_wake(Cutl_Reporter *reporter, bool *is_asleep)
+{
+	if (__atomic_load_n(is_asleep, __ATOMIC_SEQ_CST)) {
+		pthread_mutex_lock(&reporter->lock);
+		pthread_cond_broadcast(&reporter->cond);
+		pthread_mutex_unlock(&reporter->lock);
+	}
+}
+
+
+static void *cutl_reporter_main(void *data)
+{
+	Cutl_Reporter *reporter = data;
+
+	for (;;) {
+		const size_t head = reporter->head;
+		const size_t tail = __atomic_load_n(
+			&reporter->tail, __ATOMIC_ACQUIRE
+		);
+		if (head != tail) {
+			const size_t start = head & (CUTL_REPORTER_SIZE - 1);
+			size_t len = tail - head;
+			if (len > CUTL_REPORTER_SIZE - start) {
+				len = CUTL_REPORTER_SIZE - start;
+			}
+			const char *data = reporter->data + start;
+			fwrite(data, 1, len, reporter->output);
+			__atomic_store_n(
+				&reporter->head, head + len, __ATOMIC_SEQ_CST
+			);
+			cutl_reporter_wake(reporter, &reporter->is_waiting);
+			continue;
+		}
+
+		bool *is_sleeping = &reporter->is_sleeping;
+		pthread_mutex_lock(&reporter->lock);
+		__atomic_store_n(is_sleeping, true, __ATOMIC_SEQ_CST);
+		while (!reporter->is_stopping && head == __atomic_load_n(
+			&reporter->tail, __ATOMIC_SEQ_CST)
+		) {
+			pthread_cond_wait(&reporter->cond, &reporter->lock);
+		}
+		__atomic_store_n(is_sleeping, false, __ATOMIC_SEQ_CST);
+		const bool is_done = reporter->is_stopping && head
+			== __atomic_load_n(&reporter->tail, __ATOMIC_SEQ_CST);
+		pthread_mutex_unlock(&reporter->lock);
+
+		if (is_done) break;
+	}
+	fflush(reporter->output);
+
+	return NULL;
+}
+
+
+// Waits until at most `count` bytes are left in the ring.
+static void cutl_reporter_wait(Cutl_Reporter *reporter, size_t count)
+{
+	const size_t tail = reporter->tail;
+	size_t *head = &reporter->head;
+
+	pthread_mutex_lock(&reporter->lock);
+	__atomic_store_n(&reporter->is_waiting, true, __ATOMIC_SEQ_CST);
+	while (tail - __atomic_load_n(head, __ATOMIC_SEQ_CST) > count) {
+		pthread_cond_wait(&reporter->cond, &reporter->lock);
+	}
+	__atomic_store_n(&reporter->is_waiting, false, __ATOMIC_SEQ_CST);
+	pthread_mutex_unlock(&reporter->lock);
+}
+
+
+static void cutl_reporter_push(
+	Cutl_Reporter *reporter, const char *data, size_t size)
+{
+	while (size > 0) {
+		const size_t head = __atomic_load_n(
+			&reporter->head, __ATOMIC_ACQUIRE
+		);
+		const size_t tail = reporter->tail;
+		if (tail - head == CUTL_REPORTER_SIZE) {
+			cutl_reporter_wait(reporter, CUTL_REPORTER_SIZE - 1);
+			continue;
+		}
+
+		const size_t start = tail & (CUTL_REPORTER_SIZE - 1);
+		size_t len = CUTL_REPORTER_SIZE - (tail - head);
+		if (len > CUTL_REPORTER_SIZE - start) {
+			len = CUTL_REPORTER_SIZE - start;
+		}
+		if (len > size) len = size;
+
+		memcpy(reporter->data + start, data, len);
+		__atomic_store_n(&reporter->tail, tail + len, __ATOMIC_SEQ_CST);
+		cutl_reporter_wake(reporter, &reporter->is_sleeping);
+		data += len;
+		size -= len;
+	}
+}
+
+
+// The reporter writes to the output in use when it is started. Returns NULL
+// if the thread could not be started.
+static Cutl_Reporter *cutl_reporter_get(Cutl_Globals *globals, FILE *output)
+{
+	Cutl_Reporter *reporter = globals->reporter;
+	if (reporter == NULL) {
+		reporter = cutl_calloc(1, sizeof(*reporter));
+		reporter->output = output;
+		reporter->data = cutl_malloc(CUTL_REPORTER_SIZE);
+		pthread_mutex_init(&reporter->lock, NULL);
+		pthread_cond_init(&reporter->cond, NULL);
+
+		if (pthread_create(
+			&reporter->thread, NULL, cutl_reporter_main, reporter)
+		) {
+			pthread_cond_destroy(&reporter->cond);
+			pthread_mutex_destroy(&reporter->lock);
+			free(reporter->data);
+			free(reporter);
+			reporter = NULL;
+			globals->is_async = false;
+		}
+		globals->reporter = reporter;
+	}
+
+	return reporter;
+}
+
+
+static void cutl_reporter_free(Cutl_Reporter *reporter)
+{
+	if (reporter == NULL) return;
+
+	pthread_mutex_lock(&reporter->lock);
+	reporter->is_stopping = true;
+	pthread_cond_broadcast(&reporter->cond);
+	pthread_mutex_unlock(&reporter->lock);
+
+	pthread_join(reporter->thread, NULL);
+	pthread_cond_destroy(&reporter->cond);
+	pthread_mutex_destroy(&reporter->lock);
+	free(reporter->data);
+	free(reporter);
+}
+
+#endif
+
+
+// Waits until the queued lines are written to the output.
+static void cutl_drain(Cutl *cutl)
+{
+#ifdef CUTL_USE_PTHREAD
+	Cutl_Reporter *reporter = cutl->globals->reporter;
+	if (reporter == NULL || cutl->globals->is_worker) return;
+
+	cutl_reporter_wait(reporter, 0);
+	fflush(reporter->output);
+#endif
+}
+
+
+// Only the thread that started the tests queues lines, those of the tests run
+// on threads are replayed by it, and so are those of workers.
+static void cutl_write(Cutl *cutl, const void *data, size_t size)
+{
+	FILE *output = cutl->settings.output;
+
+#ifdef CUTL_USE_PTHREAD
+	Cutl_Globals *globals = cutl->globals;
+	if (!cutl->is_threaded && !globals->is_worker && globals->is_async) {
+		Cutl_Reporter *reporter = cutl_reporter_get(globals, output);
+		if (reporter != NULL && reporter->output == output) {
+			cutl_reporter_push(reporter, data, size);
+			return;
+		}
+	}
+#endif
+
+	fwrite(data, 1, size, output);
 }
 
 
 
 // MESSAGING
 
-static void cutl_indent(const Cutl *cutl)
+#define CUTL_LINE_SIZE 256
+
+// Lines are built in the buffer of the test context and written at once, so
+// that the lines of tests run on threads are never mixed.
+static char *cutl_reserve(Cutl_Buffer *buffer, size_t len)
+{
+	if (buffer->size + len >= buffer->capacity) {
+		buffer->capacity = buffer->size + len + 1 > CUTL_LINE_SIZE
+			? 2 * (buffer->size + len + 1) : CUTL_LINE_SIZE;
+		buffer->data = cutl_realloc(buffer->data, buffer->capacity);
+	}
+	return buffer->data + buffer->size;
+}
+
+
+static void cutl_append(Cutl_Buffer *buffer, const void *data, size_t len)
+{
+	memcpy(cutl_reserve(buffer, len), data, len);
+	buffer->size += len;
+}
+
+
+static void cutl_puts(Cutl *cutl, const char *str)
+{
+	cutl_append(&cutl->line, str, strlen(str));
+}
+
+
+static void cutl_vprintf(Cutl_Buffer *buffer, const char *fmt, va_list ap)
+{
+	char small[CUTL_LINE_SIZE];
+	va_list copy;
+	va_copy(copy, ap);
+	const int len = vsnprintf(small, sizeof(small), fmt, copy);
+	va_end(copy);
+	if (len < 0) return;
+
+	if ((size_t) len < sizeof(small)) {
+		cutl_append(buffer, small, len);
+		return;
+	}
+
+	// Formatted again in place when it didn't fit.
+	vsnprintf(cutl_reserve(buffer, len), len + 1, fmt, ap);
+	buffer->size += len;
+}
+
+
+static void cutl_printf(Cutl *cutl, const char *fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+	cutl_vprintf(&cutl->line, fmt, ap);
+	va_end(ap);
+}
+
+
+static void cutl_flush(Cutl *cutl)
+{
+	Cutl_Buffer *line = &cutl->line;
+	if (line->size == 0) return;
+
+	cutl_write(cutl, line->data, line->size);
+	line->size = 0;
+}
+
+
+static void cutl_indent(Cutl *cutl)
 {
 	if (CUTL_VERBCHECK(cutl, CUTL_SUITES)) {
 		for (int i=0; i<cutl->depth-1; ++i) {
-			fprintf(
-				cutl->settings.output, "%s",
-				cutl->settings.indent
-			);
+			cutl_puts(cutl, cutl->settings.indent);
 		}
 	}
 }
@@ -427,24 +1833,39 @@ static void cutl_infix(Cutl *cutl, const char *str)
 
 	if (cutl->is_infixed || !cutl->is_prefixed || cutl->depth == 0) return;
 
-	fprintf(cutl->settings.output, "%s\n", str);
+	cutl_puts(cutl, str);
+	cutl_puts(cutl, "\n");
+	cutl_flush(cutl);
 	cutl->is_infixed = true;
 }
 
 
+static void cutl_prefix(Cutl *cutl);
+
+static void cutl_prefix_parent(Cutl *cutl)
+{
+	if (CUTL_VERBCHECK(cutl, CUTL_SUITES)) {
+		cutl_prefix(cutl->parent);
+	}
+
+	cutl_infix(cutl->parent, ":");
+}
+
+
 static void cutl_prefix(Cutl *cutl)
 {
 	if (cutl->name == NULL) return cutl_prefix(cutl->parent);
 
 	if (cutl->is_prefixed || cutl->depth == 0) return;
 
-	if (CUTL_VERBCHECK(cutl, CUTL_SUITES)) {
-		cutl_prefix(cutl->parent);
+	// Detached tests leave their parent alone, it gets prefixed when they
+	// are joined.
+	if (!cutl->is_detached) {
+		cutl_prefix_parent(cutl);
 	}
 
-	cutl_infix(cutl->parent, ":");
 	cutl_indent(cutl);
-	fprintf(cutl->settings.output, "%s", cutl->name);
+	cutl_puts(cutl, cutl->name);
 	cutl->is_prefixed = true;
 }
 
@@ -457,185 +1878,4170 @@ static void cutl_suffix(Cutl *cutl)
 
 	if (cutl->is_infixed) {
 		cutl_indent(cutl);
-		fprintf(cutl->settings.output, "%s", cutl->name);
+		cutl_puts(cutl, cutl->name);
 	}
 
-	fprintf(
-		cutl->settings.output, " %s.\n",
-		cutl->error ? "canceled" : cutl->failed ? "failed" : "passed"
+	cutl_puts(
+		cutl, cutl->error ? " canceled" : cutl->failed ? " failed"
+		: " passed"
 	);
+	if (CUTL_VERBCHECK(cutl, CUTL_TIMES)) {
+		cutl_printf(
+			cutl, " (%.3f ms, %.3f ms CPU", cutl->duration * 1e3,
+			cutl->cpu_duration * 1e3
+		);
+#ifdef CUTL_HEAP_ENABLED
+		if (cutl->settings.leaks != 0) {
+			cutl_printf(
+				cutl, ", %zu bytes peak in %zu allocations",
+				cutl->heap.peak, cutl->heap.nb_allocs
+			);
+		}
+#endif
+		cutl_puts(cutl, ")");
+	}
+	cutl_puts(cutl, ".\n");
+	cutl_flush(cutl);
+}
+
+
+static void cutl_report_message(
+	Cutl *cutl, int type, const char *file, int line, const char *fmt,
+	va_list ap);
+
+static void cutl_vmessage_at(
+	Cutl *cutl, int type, const char *file, int line, const char *fmt,
+	va_list ap)
+{
+	assert(cutl != NULL);
+	assert(fmt != NULL);
+
+	if (type & CUTL_ERROR) {
+		cutl->error = true;
+		cutl->failed = true;
+	} if (type & CUTL_FAIL) {
+		cutl->failed = true;
+	}
+
+	va_list copy;
+	va_copy(copy, ap);
+	cutl_report_message(cutl, type, file, line, fmt, copy);
+	va_end(copy);
+
+	if (!CUTL_VERBCHECK(cutl, type)) return;
+
+	// Timeouts must not interrupt the test while it prints.
+	const int stage = cutl->stage;
+	cutl->stage = 0;
+
+	cutl_join(cutl);
+
+	cutl_prefix(cutl);
+	cutl_infix(cutl, ":");
+	cutl_indent(cutl);
+	if (cutl->depth > 0) {
+		// Extra indentation if test has a parent.
+		cutl_puts(cutl, cutl->settings.indent);
+	}
+
+	const char *kind = NULL;
+	if (type & CUTL_ERROR) {
+		kind = cutl->has_color
+			? "\033"CUTL_FAIL_COLOR"ERROR\033[0m" : "ERROR";
+	} else if (type & CUTL_FAIL) {
+		kind = cutl->has_color
+			? "\033"CUTL_FAIL_COLOR"FAIL\033[0m" : "FAIL";
+	} else if (type & CUTL_WARN) {
+		kind = "WARN";
+	} else if (type & CUTL_INFO) {
+		kind = "INFO";
+	}
+
+	if (kind) {
+		if (file) {
+			cutl_printf(cutl, "[%s %s:%d] ", kind, file, line);
+		} else {
+			cutl_printf(cutl, "[%s] ", kind);
+		}
+	}
+
+	cutl_vprintf(&cutl->line, fmt, ap);
+
+	cutl_puts(cutl, "\n");
+	cutl_flush(cutl);
+
+	cutl->stage = stage;
+}
+
+void cutl_message_at(
+	Cutl *cutl, int type, const char *file, int line, const char *fmt, ...)
+{
+	assert(cutl != NULL);
+	assert(fmt != NULL);
+
+	va_list ap;
+	va_start(ap, fmt);
+	cutl_vmessage_at(cutl, type, file, line, fmt, ap);
+	va_end(ap);
+}
+
+
+
+// REPORTS
+
+// Messages are kept by their test until it ends, each as a record followed by
+// its null-terminated file name and text.
+typedef struct {
+	int type, line;
+	size_t file_size, text_size;
+} Cutl_Record;
+
+
+// Writers of each format. The formats that keep records are given the
+// messages of each test when it ends, the others as they are printed.
+// Reports start with the header of their format, if any.
+typedef struct {
+	int format;
+	const char *name, *header;
+	bool has_records;
+	void (*begin)(FILE *report, const Cutl *root);
+	void (*start)(FILE *report, const Cutl *cutl);
+	void (*message)(
+		FILE *report, const Cutl *cutl, const Cutl_Record *record,
+		const char *file, const char *text
+	);
+	void (*open)(FILE *report, const Cutl *cutl);
+	void (*end)(FILE *report, const Cutl *cutl);
+} Cutl_Writer;
+
+static const Cutl_Writer cutl_writers[CUTL_NB_REPORTS];
+
+
+// Tests handed to parallel jobs write their reports to streams of their own,
+// which are replayed into the reports of their parent when they are joined.
+static FILE *cutl_report_file(const Cutl *cutl, int index)
+{
+	for (; cutl != NULL; cutl = cutl->parent) {
+		if (cutl->reports[index] != NULL) return cutl->reports[index];
+	}
+	return NULL;
+}
+
+
+static bool cutl_report_any(const Cutl *cutl)
+{
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		if (cutl_report_file(cutl, i) != NULL) return true;
+	}
+	return false;
+}
+
+
+static bool cutl_report_owns(const Cutl *cutl, FILE *report)
+{
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		if (cutl->reports[i] == report) return true;
+	}
+	return false;
+}
+
+
+// Returns the innermost named test that contains this one.
+static Cutl *cutl_report_parent(const Cutl *cutl)
+{
+	Cutl *parent = cutl->parent;
+	while (parent != NULL && parent->name == NULL) {
+		parent = parent->parent;
+	}
+	return parent;
+}
+
+
+
+static void cutl_report_message(
+	Cutl *cutl, int type, const char *file, int line, const char *fmt,
+	va_list ap)
+{
+	const int kinds = CUTL_ERROR | CUTL_FAIL | CUTL_WARN | CUTL_INFO;
+	if (!(type & kinds) || !cutl_report_any(cutl)) return;
+
+	// Timeouts must not interrupt the test while it allocates.
+	const int stage = cutl->stage;
+	cutl->stage = 0;
+
+	// Anonymous tests report in their parent.
+	Cutl *owner = cutl;
+	while (owner->name == NULL && owner->parent != NULL) {
+		owner = owner->parent;
+	}
+
+	Cutl_Buffer *records = &owner->records;
+	const size_t start = records->size;
+	Cutl_Record record = {
+		.type = type, .line = line,
+		.file_size = file != NULL ? strlen(file) : 0,
+	};
+	cutl_append(records, &record, sizeof(record));
+	cutl_append(records, file != NULL ? file : "", record.file_size + 1);
+	const size_t text = records->size;
+	cutl_vprintf(records, fmt, ap);
+	record.text_size = records->size - text;
+	cutl_append(records, "", 1);
+	memcpy(records->data + start, &record, sizeof(record));
+
+	// Streamed formats write the message at once, it is only kept for the
+	// others.
+	bool is_kept = false;
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		const Cutl_Writer *writer = &cutl_writers[i];
+		FILE *report = cutl_report_file(owner, i);
+		if (report == NULL) continue;
+
+		if (writer->message != NULL) {
+			writer->message(
+				report, owner, &record,
+				records->data + start + sizeof(record),
+				records->data + text
+			);
+		}
+		is_kept = is_kept || writer->has_records;
+	}
+	if (!is_kept) records->size = start;
+
+	cutl->stage = stage;
+}
+
+
+// Returns the record at `*pos` and moves past it, or NULL at the end.
+static const Cutl_Record *cutl_record_next(
+	const Cutl *cutl, size_t *pos, Cutl_Record *record, const char **file,
+	const char **text)
+{
+	if (*pos >= cutl->records.size) return NULL;
+
+	const char *data = cutl->records.data + *pos;
+	memcpy(record, data, sizeof(*record));
+	*file = data + sizeof(*record);
+	*text = *file + record->file_size + 1;
+	*pos += sizeof(*record) + record->file_size + record->text_size + 2;
+	return record;
+}
+
+
+static const char *cutl_record_kind(int type)
+{
+	return (type & CUTL_ERROR) ? "ERROR" : (type & CUTL_FAIL) ? "FAIL"
+		: (type & CUTL_WARN) ? "WARN" : "INFO";
+}
+
+
+// Control characters other than white space are not allowed in XML.
+static void cutl_junit_escape(FILE *report, const char *str)
+{
+	for (const char *c = str; *c != '\0'; ++c) {
+		switch (*c) {
+		case '&': fputs("&amp;", report); break;
+		case '<': fputs("&lt;", report); break;
+		case '>': fputs("&gt;", report); break;
+		case '"': fputs("&quot;", report); break;
+		case '\n': fputs("&#10;", report); break;
+		case '\t': case '\r': fputc(*c, report); break;
+		default:
+			fputc((unsigned char) *c < 0x20 ? '?' : *c, report);
+		}
+	}
+}
+
+
+static void cutl_junit_indent(FILE *report, int depth)
+{
+	fprintf(report, "%*s", 2 * (depth + 1), "");
+}
+
+
+// Dotted names of the suites, from the outermost one below the root.
+static void cutl_junit_path(FILE *report, const Cutl *cutl)
+{
+	if (cutl->name == NULL) return cutl_junit_path(report, cutl->parent);
+
+	if (cutl->depth > 1) {
+		cutl_junit_path(report, cutl->parent);
+		fputc('.', report);
+	}
+	cutl_junit_escape(report, cutl->name);
+}
+
+
+// Writes the messages of the given types as lines of a single element.
+static void cutl_junit_lines(
+	FILE *report, const Cutl *cutl, int types, const char *tag)
+{
+	bool is_open = false;
+	Cutl_Record record;
+	const char *file, *text;
+	size_t pos = 0;
+	while (cutl_record_next(cutl, &pos, &record, &file, &text)) {
+		if (!(record.type & types)) continue;
+
+		if (!is_open) {
+			cutl_junit_indent(report, cutl->depth + 1);
+			fprintf(report, "<%s>", tag);
+			is_open = true;
+		}
+		fprintf(report, "[%s", cutl_record_kind(record.type));
+		if (*file != '\0') {
+			fputc(' ', report);
+			cutl_junit_escape(report, file);
+			fprintf(report, ":%d", record.line);
+		}
+		fputs("] ", report);
+		cutl_junit_escape(report, text);
+		fputs("&#10;", report);
+	}
+	if (is_open) fprintf(report, "</%s>\n", tag);
+}
+
+
+static void cutl_junit_failures(FILE *report, const Cutl *cutl)
+{
+	bool has_failure = false;
+	Cutl_Record record;
+	const char *file, *text;
+	size_t pos = 0;
+	while (cutl_record_next(cutl, &pos, &record, &file, &text)) {
+		if (!(record.type & (CUTL_ERROR | CUTL_FAIL))) continue;
+
+		const char *tag = (record.type & CUTL_ERROR)
+			? "error" : "failure";
+		cutl_junit_indent(report, cutl->depth + 1);
+		fprintf(
+			report, "<%s type=\"%s\" message=\"", tag,
+			cutl_record_kind(record.type)
+		);
+		cutl_junit_escape(report, text);
+		if (*file != '\0') {
+			fputs("\">", report);
+			cutl_junit_escape(report, file);
+			fprintf(report, ":%d</%s>\n", record.line, tag);
+		} else {
+			fputs("\"/>\n", report);
+		}
+		has_failure = true;
+	}
+
+	if (cutl->failed && !has_failure) {
+		cutl_junit_indent(report, cutl->depth + 1);
+		fputs("<failure type=\"FAIL\"/>\n", report);
+	}
+}
+
+
+static void cutl_junit_open(FILE *report, const Cutl *cutl)
+{
+	cutl_junit_indent(report, cutl->depth);
+	fputs("<testsuite name=\"", report);
+	cutl_junit_escape(report, cutl->name);
+	fputs("\">\n", report);
+}
+
+
+static void cutl_junit_begin(FILE *report, const Cutl *root)
+{
+	fputs("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n", report);
+	fputs("<testsuites>\n", report);
+	cutl_junit_open(report, root);
+}
+
+
+// Suites are closed with the messages they printed themselves, tests are
+// written whole.
+static void cutl_junit_end(FILE *report, const Cutl *cutl)
+{
+	const int failures = CUTL_ERROR | CUTL_FAIL;
+	const int others = CUTL_WARN | CUTL_INFO;
+	if (cutl->is_reported) {
+		cutl_junit_lines(report, cutl, others, "system-out");
+		cutl_junit_lines(report, cutl, failures, "system-err");
+		cutl_junit_indent(report, cutl->depth);
+		fputs("</testsuite>\n", report);
+	} else {
+		cutl_junit_indent(report, cutl->depth);
+		fputs("<testcase name=\"", report);
+		cutl_junit_escape(report, cutl->name);
+		fputs("\" classname=\"", report);
+		cutl_junit_path(report, cutl->parent);
+		fprintf(report, "\" time=\"%.6f\"", cutl->duration);
+		if (cutl->records.size == 0 && !cutl->failed) {
+			fputs("/>\n", report);
+		} else {
+			fputs(">\n", report);
+			cutl_junit_failures(report, cutl);
+			cutl_junit_lines(report, cutl, others, "system-out");
+			cutl_junit_indent(report, cutl->depth);
+			fputs("</testcase>\n", report);
+		}
+	}
+
+	if (cutl->parent == NULL) {
+		fputs("</testsuites>\n", report);
+	}
+}
+
+
+// Characters with a meaning in YAML double-quoted strings are escaped.
+static void cutl_tap_quote(FILE *report, const char *str)
+{
+	fputc('"', report);
+	for (const char *c = str; *c != '\0'; ++c) {
+		switch (*c) {
+		case '"': fputs("\\\"", report); break;
+		case '\\': fputs("\\\\", report); break;
+		case '\n': fputs("\\n", report); break;
+		case '\t': fputs("\\t", report); break;
+		default:
+			if ((unsigned char) *c < 0x20) {
+				fprintf(report, "\\x%02x", (unsigned char) *c);
+			} else {
+				fputc(*c, report);
+			}
+		}
+	}
+	fputc('"', report);
+}
+
+
+// Descriptions must not start a directive.
+static void cutl_tap_escape(FILE *report, const char *str)
+{
+	for (const char *c = str; *c != '\0'; ++c) {
+		if (*c == '#' || *c == '\\') fputc('\\', report);
+		fputc(*c == '\n' ? ' ' : *c, report);
+	}
+}
+
+
+// Writes the messages of the test as a YAML block under its test point.
+static void cutl_tap_yaml(FILE *report, const Cutl *cutl, int indent)
+{
+	if (cutl->records.size == 0) return;
+
+	fprintf(report, "%*s---\n", indent, "");
+	fprintf(report, "%*smessages:\n", indent, "");
+
+	Cutl_Record record;
+	const char *file, *text;
+	size_t pos = 0;
+	while (cutl_record_next(cutl, &pos, &record, &file, &text)) {
+		const char *kind = cutl_record_kind(record.type);
+		fprintf(report, "%*s  - severity: ", indent, "");
+		for (const char *c = kind; *c != '\0'; ++c) {
+			fputc(tolower((unsigned char) *c), report);
+		}
+		fprintf(report, "\n%*s    message: ", indent, "");
+		cutl_tap_quote(report, text);
+		fputc('\n', report);
+		if (*file != '\0') {
+			fprintf(report, "%*s    at:\n", indent, "");
+			fprintf(report, "%*s      file: ", indent, "");
+			cutl_tap_quote(report, file);
+			fprintf(
+				report, "\n%*s      line: %d\n", indent, "",
+				record.line
+			);
+		}
+	}
+	fprintf(report, "%*s...\n", indent, "");
+}
+
+
+static void cutl_tap_open(FILE *report, const Cutl *cutl)
+{
+	fprintf(report, "%*s# Subtest: ", 4 * cutl->depth, "");
+	cutl_tap_escape(report, cutl->name);
+	fputc('\n', report);
+}
+
+
+// Plans come last, so that tests are written as they end. Messages of the
+// root are only comments, it is not a test.
+static void cutl_tap_end(FILE *report, const Cutl *cutl)
+{
+	if (cutl->parent == NULL) {
+		Cutl_Record record;
+		const char *file, *text;
+		size_t pos = 0;
+		while (cutl_record_next(cutl, &pos, &record, &file, &text)) {
+			const char *kind = cutl_record_kind(record.type);
+			fprintf(report, "# [%s] ", kind);
+			cutl_tap_escape(report, text);
+			fputc('\n', report);
+		}
+		fprintf(report, "1..%d\n", cutl->nb_reported);
+		return;
+	}
+
+	// Tests of the root are not indented, those of suites are subtests.
+	const int indent = 4 * (cutl->depth - 1);
+	if (cutl->is_reported) {
+		fprintf(
+			report, "%*s1..%d\n", indent + 4, "", cutl->nb_reported
+		);
+	}
+	const char *result = cutl->failed ? "not ok" : "ok";
+	fprintf(report, "%*s%s - ", indent, "", result);
+	cutl_tap_escape(report, cutl->name);
+	fputc('\n', report);
+	cutl_tap_yaml(report, cutl, indent + 2);
+}
+
+
+// Strings are escaped as JSON requires, other bytes are kept as they are.
+static void cutl_json_string(FILE *report, const char *str)
+{
+	fputc('"', report);
+	for (const char *c = str; *c != '\0'; ++c) {
+		switch (*c) {
+		case '"': fputs("\\\"", report); break;
+		case '\\': fputs("\\\\", report); break;
+		case '\n': fputs("\\n", report); break;
+		case '\t': fputs("\\t", report); break;
+		default:
+			if ((unsigned char) *c < 0x20) {
+				fprintf(report, "\\u%04x", (unsigned char) *c);
+			} else {
+				fputc(*c, report);
+			}
+		}
+	}
+	fputc('"', report);
+}
+
+
+// Writes the names from the root down, the root left out. Returns whether
+// any was written.
+static bool cutl_json_path(FILE *report, const Cutl *cutl)
+{
+	if (cutl->parent == NULL) return false;
+
+	const bool has_names = cutl_json_path(report, cutl->parent);
+	if (cutl->name == NULL) return has_names;
+
+	if (has_names) fputc(',', report);
+	cutl_json_string(report, cutl->name);
+	return true;
+}
+
+
+// Every event starts with the test it is about.
+static void cutl_json_head(FILE *report, const char *event, const Cutl *cutl)
+{
+	fprintf(report, "{\"event\":\"%s\",\"id\":%d,", event, cutl->id);
+	const Cutl *parent = cutl_report_parent(cutl);
+	if (parent != NULL) {
+		fprintf(report, "\"parent\":%d,", parent->id);
+	} else {
+		fputs("\"parent\":null,", report);
+	}
+	fprintf(
+		report, "\"key\":%lu,\"depth\":%d,\"path\":[",
+		(unsigned long) cutl->key, cutl->depth
+	);
+	cutl_json_path(report, cutl);
+	fputc(']', report);
+}
+
+
+static const char *cutl_json_status(const Cutl *cutl)
+{
+	return cutl->error ? "canceled" : cutl->failed ? "failed" : "passed";
+}
+
+
+static void cutl_json_start(FILE *report, const Cutl *cutl)
+{
+	cutl_json_head(report, "test_start", cutl);
+	fputs("}\n", report);
+}
+
+
+static void cutl_json_message(
+	FILE *report, const Cutl *cutl, const Cutl_Record *record,
+	const char *file, const char *text)
+{
+	cutl_json_head(report, "message", cutl);
+	fputs(",\"severity\":\"", report);
+	for (const char *c = cutl_record_kind(record->type); *c; ++c) {
+		fputc(tolower((unsigned char) *c), report);
+	}
+	fputs("\",\"file\":", report);
+	if (*file != '\0') {
+		cutl_json_string(report, file);
+		fprintf(report, ",\"line\":%d", record->line);
+	} else {
+		fputs("null,\"line\":null", report);
+	}
+	fputs(",\"text\":", report);
+	cutl_json_string(report, text);
+	fputs("}\n", report);
+}
+
+
+// The root ends with the summary of the whole run.
+static void cutl_json_end(FILE *report, const Cutl *cutl)
+{
+	const bool is_root = cutl->parent == NULL;
+	if (is_root) {
+		cutl_json_head(report, "summary", cutl);
+	} else {
+		cutl_json_head(report, "test_end", cutl);
+		fprintf(
+			report, ",\"suite\":%s,\"duration\":%.6f,"
+			"\"cpu_duration\":%.6f", cutl->is_reported ? "true"
+			: "false", cutl->duration, cutl->cpu_duration
+		);
+	}
+	fprintf(report, ",\"status\":\"%s\"", cutl_json_status(cutl));
+
+	// Tests are counted by the suites that contain them.
+	if (is_root || cutl->is_reported) {
+		fprintf(
+			report, ",\"passed\":%d,\"failed\":%d,\"skipped\":%d",
+			cutl->nb_passed, cutl->nb_failed, cutl->nb_skipped
+		);
+	}
+	fputs("}\n", report);
+}
+
+
+// Ids of strings are FNV-1a hashes, on 64 bits so that distinct strings hardly
+// ever share one.
+static uint64_t cutl_log_id(const char *str)
+{
+	if (*str == '\0') return 0;
+
+	uint64_t hash = UINT64_C(14695981039346656037);
+	for (const char *c = str; *c != '\0'; ++c) {
+		hash = (hash ^ (unsigned char) *c) * UINT64_C(1099511628211);
+	}
+	return hash != 0 ? hash : 1;
+}
+
+
+// Returns whether the id was added, or true if the set could not grow, so
+// that the string is written again rather than missing.
+static bool cutl_strings_add(Cutl_Strings *strings, uint64_t id)
+{
+	if (2 * (strings->count + 1) > strings->capacity) {
+		const size_t capacity = strings->capacity > 0
+			? 2 * strings->capacity : 64;
+		uint64_t *ids = calloc(capacity, sizeof(*ids));
+		if (ids == NULL) return true;
+
+		for (size_t i=0; i<strings->capacity; ++i) {
+			const uint64_t old = strings->ids[i];
+			if (old == 0) continue;
+
+			size_t j = old & (capacity - 1);
+			while (ids[j] != 0) j = (j + 1) & (capacity - 1);
+			ids[j] = old;
+		}
+		free(strings->ids);
+		strings->ids = ids;
+		strings->capacity = capacity;
+	}
+
+	const size_t mask = strings->capacity - 1;
+	size_t i = id & mask;
+	for (; strings->ids[i] != 0; i = (i + 1) & mask) {
+		if (strings->ids[i] == id) return false;
+	}
+	strings->ids[i] = id;
+	strings->count++;
+	return true;
+}
+
+
+static Cutl_Log_Record cutl_log_record(int type, const Cutl *cutl)
+{
+	const Cutl *parent = cutl_report_parent(cutl);
+	return (Cutl_Log_Record) {
+		.type = type, .depth = cutl->depth, .id = cutl->id,
+		.parent = parent != NULL ? parent->id : -1,
+	};
+}
+
+
+// Strings are written once per stream, which is owned by the root or by a
+// test run in a job.
+static uint64_t cutl_log_string(
+	FILE *report, const Cutl *cutl, const char *str)
+{
+	const uint64_t id = cutl_log_id(str);
+	if (id == 0) return 0;
+
+	const Cutl *owner = cutl;
+	while (owner->parent != NULL && !cutl_report_owns(owner, report)) {
+		owner = owner->parent;
+	}
+	if (cutl_strings_add((Cutl_Strings*) &owner->strings, id)) {
+		Cutl_Log_Record record = cutl_log_record(CUTL_LOG_STRING, cutl);
+		record.name = id;
+		record.size = strlen(str);
+		fwrite(&record, sizeof(record), 1, report);
+		fwrite(str, 1, record.size, report);
+	}
+	return id;
+}
+
+
+static int cutl_log_status(const Cutl *cutl)
+{
+	return cutl->error ? CUTL_LOG_CANCELED
+		: cutl->failed ? CUTL_LOG_FAILED : CUTL_LOG_PASSED;
+}
+
+
+static void cutl_binary_begin(FILE *report, const Cutl *root)
+{
+	Cutl_Log_Record record = cutl_log_record(CUTL_LOG_BEGIN, root);
+	record.name = CUTL_LOG_MAGIC;
+	record.size = sizeof(record);
+	record.time = cutl_time();
+	fwrite(&record, sizeof(record), 1, report);
+}
+
+
+static void cutl_binary_start(FILE *report, const Cutl *cutl)
+{
+	Cutl_Log_Record record = cutl_log_record(CUTL_LOG_START, cutl);
+	record.name = cutl_log_string(report, cutl, cutl->name);
+	record.time = cutl->started;
+	fwrite(&record, sizeof(record), 1, report);
+}
+
+
+static void cutl_binary_message(
+	FILE *report, const Cutl *cutl, const Cutl_Record *message,
+	const char *file, const char *text)
+{
+	Cutl_Log_Record record = cutl_log_record(CUTL_LOG_MESSAGE, cutl);
+	record.status = message->type;
+	record.name = cutl_log_string(report, cutl, text);
+	record.file = cutl_log_string(report, cutl, file);
+	record.line = message->line;
+	record.time = cutl_time();
+	fwrite(&record, sizeof(record), 1, report);
+}
+
+
+static void cutl_binary_end(FILE *report, const Cutl *cutl)
+{
+	const bool is_root = cutl->parent == NULL;
+	Cutl_Log_Record record = cutl_log_record(
+		is_root ? CUTL_LOG_SUMMARY : CUTL_LOG_END, cutl
+	);
+	record.status = cutl_log_status(cutl);
+	record.passed = cutl->nb_passed;
+	record.failed = cutl->nb_failed;
+	record.skipped = cutl->nb_skipped;
+	if (is_root) {
+		record.time = cutl_time();
+	} else {
+		record.name = cutl_log_string(report, cutl, cutl->name);
+		record.size = cutl->is_reported;
+		record.time = cutl->started + cutl->duration;
+		record.duration = cutl->duration;
+		record.cpu_duration = cutl->cpu_duration;
+	}
+	fwrite(&record, sizeof(record), 1, report);
+}
+
+
+static const Cutl_Writer cutl_writers[CUTL_NB_REPORTS] = {
+	{
+		.format = CUTL_JUNIT, .name = "junit", .has_records = true,
+		.begin = cutl_junit_begin, .open = cutl_junit_open,
+		.end = cutl_junit_end,
+	},
+	{
+		.format = CUTL_TAP, .name = "tap", .has_records = true,
+		.header = "TAP version 14\n", .open = cutl_tap_open,
+		.end = cutl_tap_end,
+	},
+	{
+		.format = CUTL_JSON, .name = "json",
+		.start = cutl_json_start, .message = cutl_json_message,
+		.end = cutl_json_end,
+	},
+	{
+		.format = CUTL_BINARY, .name = "bin",
+		.begin = cutl_binary_begin, .start = cutl_binary_start,
+		.message = cutl_binary_message, .end = cutl_binary_end,
+	},
+};
+
+
+// Returns the index of the writer of the format, or -1.
+static int cutl_writer_find(int format)
+{
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		if (cutl_writers[i].format == format) return i;
+	}
+	return -1;
+}
+
+
+static int cutl_report_formats(const Cutl *root)
+{
+	int formats = CUTL_NO_REPORT;
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		if (root->reports[i] != NULL) formats |= cutl_writers[i].format;
+	}
+	return formats;
+}
+
+
+// Suites are opened when their first test ends, until then they could still
+// turn out to be a test themselves.
+static void cutl_report_open(Cutl *cutl)
+{
+	if (cutl->name == NULL) return cutl_report_open(cutl->parent);
+
+	if (cutl->is_reported || cutl->parent == NULL) return;
+
+	// Detached tests leave their parent alone, it gets opened when they are
+	// joined.
+	if (!cutl->is_detached) {
+		cutl_report_open(cutl->parent);
+	}
+
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		FILE *report = cutl_report_file(cutl, i);
+		if (report != NULL && cutl_writers[i].open != NULL) {
+			cutl_writers[i].open(report, cutl);
+		}
+	}
+	cutl->is_reported = true;
+}
+
+
+static void cutl_report_begin(Cutl *root, int index)
+{
+	FILE *report = root->reports[index];
+	if (report == NULL) return;
+
+	if (cutl_writers[index].header != NULL) {
+		fputs(cutl_writers[index].header, report);
+	}
+	if (cutl_writers[index].begin != NULL) {
+		cutl_writers[index].begin(report, root);
+	}
+	root->is_reported = true;
+}
+
+
+static void cutl_report_start(Cutl *cutl)
+{
+	if (cutl->name == NULL) return;
+
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		FILE *report = cutl_report_file(cutl, i);
+		if (report != NULL && cutl_writers[i].start != NULL) {
+			cutl_writers[i].start(report, cutl);
+		}
+	}
+}
+
+
+// The root completes one of its reports, and is done reporting with the last
+// one.
+static void cutl_report_stop(Cutl *root, int index)
+{
+	FILE *report = root->reports[index];
+	if (report == NULL) return;
+
+	cutl_writers[index].end(report, root);
+	fflush(report);
+	root->reports[index] = NULL;
+	free(root->strings.ids);
+	root->strings = (Cutl_Strings) {0};
+
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		if (root->reports[i] != NULL) return;
+	}
+	free(root->records.data);
+	root->records = (Cutl_Buffer) {0};
+	root->is_reported = false;
+	root->nb_reported = 0;
+}
+
+
+// The report in progress is completed before another one is set.
+static void cutl_report_set(Cutl *root, int index, FILE *report)
+{
+	cutl_report_stop(root, index);
+	root->reports[index] = report;
+	cutl_report_begin(root, index);
+}
+
+
+// Arguments are the name of the format and the path, as in "junit:<file>".
+// Returns the index of the writer, or -1.
+static int cutl_report_parse(const char *arg, const char **path)
+{
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		const size_t len = strlen(cutl_writers[i].name);
+		if (strncmp(arg, cutl_writers[i].name, len) == 0
+			&& arg[len] == ':'
+		) {
+			*path = arg + len + 1;
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+static void cutl_report_end(Cutl *cutl)
+{
+	if (cutl->parent == NULL) {
+		for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+			cutl_report_stop(cutl, i);
+		}
+		return;
+	}
+
+	if (cutl->name == NULL || !cutl_report_any(cutl)) return;
+
+	// Tests of jobs are counted by their parent once joined.
+	Cutl *parent = cutl_report_parent(cutl);
+	if (parent != NULL && !cutl->is_detached) {
+		cutl_report_open(parent);
+		parent->nb_reported++;
+	}
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		FILE *report = cutl_report_file(cutl, i);
+		if (report != NULL) cutl_writers[i].end(report, cutl);
+	}
+
+	free(cutl->records.data);
+	cutl->records = (Cutl_Buffer) {0};
+	cutl->is_reported = false;
+	cutl->nb_reported = 0;
+}
+
+
+// Replays a report of a job into the report of its parent, where it counts
+// as a single test.
+static void cutl_report_write(
+	Cutl *cutl, int index, const void *data, size_t size)
+{
+	if (size == 0) return;
+
+	Cutl *parent = cutl_report_parent(cutl);
+	cutl_report_open(parent);
+	fwrite(data, 1, size, cutl_report_file(parent, index));
+}
+
+
+// TIMINGS
+
+static void cutl_lock(Cutl_Globals *globals)
+{
+#ifdef CUTL_USE_PTHREAD
+	pthread_mutex_lock(&globals->lock);
+#endif
+}
+
+
+static void cutl_unlock(Cutl_Globals *globals)
+{
+#ifdef CUTL_USE_PTHREAD
+	pthread_mutex_unlock(&globals->lock);
+#endif
+}
+
+
+static void cutl_timings_push(Cutl_Timings *timings, Cutl_Timing timing)
+{
+	if (timings->size == timings->capacity) {
+		const size_t capacity = timings->capacity
+			? 2 * timings->capacity : 64;
+		timings->items = cutl_realloc(
+			timings->items, capacity * sizeof(*timings->items)
+		);
+		timings->capacity = capacity;
+	}
+	timings->items[timings->size++] = timing;
+}
+
+
+static void cutl_timing_free(Cutl_Timing *timing)
+{
+	free(timing->samples);
+	free(timing->functions);
+	free(timing->name);
+}
+
+
+static void cutl_timings_free(Cutl_Timings *timings)
+{
+	for (size_t i=0; i<timings->size; ++i) {
+		cutl_timing_free(&timings->items[i]);
+	}
+	free(timings->items);
+	memset(timings, 0, sizeof(*timings));
+}
+
+
+static int cutl_timing_cmp_key(const void *a, const void *b)
+{
+	const Cutl_Timing *ta = a, *tb = b;
+	return (ta->key > tb->key) - (ta->key < tb->key);
+}
+
+
+static int cutl_timing_cmp_duration(const void *a, const void *b)
+{
+	const Cutl_Timing *ta = *(Cutl_Timing * const *) a;
+	const Cutl_Timing *tb = *(Cutl_Timing * const *) b;
+	if (ta->duration != tb->duration) {
+		return ta->duration < tb->duration ? 1 : -1;
+	}
+	return cutl_timing_cmp_key(ta, tb);
+}
+
+
+// Sorts by key and keeps the longest duration of tests listed more than once,
+// as when the files of several shards are concatenated.
+static void cutl_timings_sort(Cutl_Timings *timings)
+{
+	if (timings->size == 0) return;
+
+	qsort(
+		timings->items, timings->size, sizeof(*timings->items),
+		cutl_timing_cmp_key
+	);
+
+	size_t size = 1;
+	for (size_t i=1; i<timings->size; ++i) {
+		Cutl_Timing *last = &timings->items[size - 1];
+		Cutl_Timing *timing = &timings->items[i];
+		if (timing->key != last->key) {
+			timings->items[size++] = *timing;
+		} else if (timing->duration > last->duration) {
+			cutl_timing_free(last);
+			*last = *timing;
+		} else {
+			cutl_timing_free(timing);
+		}
+	}
+	timings->size = size;
+}
+
+
+static char *cutl_read_line(FILE *input)
+{
+	size_t size = 0, capacity = 64;
+	char *line = cutl_malloc(capacity);
+
+	int c;
+	while ((c = fgetc(input)) != EOF && c != '\n') {
+		if (size + 1 == capacity) {
+			capacity *= 2;
+			line = cutl_realloc(line, capacity);
+		}
+		line[size++] = c;
+	}
+	line[size] = '\0';
+
+	return line;
+}
+
+
+// Files of durations, one test per line, with its key first and its name
+// last.
+enum {
+	CUTL_TIMINGS_FILE,
+
+	// Samples of benchmarks after their duration, preceded by their number.
+	CUTL_BASELINE_FILE,
+
+	// Status of tests after their duration, 'P' if passed or 'F' if failed,
+	// then the fingerprint of the functions they covered and the hashes of
+	// their names, preceded by their number.
+	CUTL_CACHE_FILE,
+};
+
+
+static bool cutl_functions_read(FILE *input, Cutl_Timing *timing)
+{
+	unsigned long fingerprint;
+	int count;
+	if (fscanf(input, "%lx %d", &fingerprint, &count) != 2 || count < 0) {
+		return false;
+	}
+
+	uint32_t *functions = cutl_malloc(count * sizeof(*functions));
+	for (int i=0; i<count; ++i) {
+		unsigned long function;
+		if (fscanf(input, "%lx", &function) != 1) {
+			free(functions);
+			return false;
+		}
+		functions[i] = function;
+	}
+	timing->fingerprint = fingerprint;
+	timing->nb_functions = count;
+	timing->functions = functions;
+	return true;
+}
+
+
+static void cutl_timings_load(Cutl_Timings *timings, const char *path, int file)
+{
+	cutl_timings_free(timings);
+
+	// A missing file is an empty history.
+	FILE *input = path ? fopen(path, "r") : NULL;
+	if (input == NULL) return;
+
+	unsigned long key;
+	Cutl_Timing timing = {0};
+	while (fscanf(input, "%lx %lf", &key, &timing.duration) == 2) {
+		timing.key = key;
+		if (file == CUTL_CACHE_FILE) {
+			if (fscanf(input, " %c", &timing.status) != 1) break;
+			if (timing.status != 'P' && timing.status != 'F') break;
+			if (!cutl_functions_read(input, &timing)) break;
+		}
+		if (file == CUTL_BASELINE_FILE) {
+			int count;
+			if (fscanf(input, "%d", &count) != 1 || count < 0
+				|| count > CUTL_BENCH_SAMPLES
+			) break;
+
+			double *samples = cutl_malloc(
+				CUTL_BENCH_SAMPLES * sizeof(*samples)
+			);
+			int i = 0;
+			while (i < count
+				&& fscanf(input, "%lf", &samples[i]) == 1
+			) {
+				i++;
+			}
+			if (i < count) {
+				free(samples);
+				break;
+			}
+			timing.nb_samples = count;
+			timing.samples = samples;
+		}
+		fgetc(input);
+		timing.name = cutl_read_line(input);
+		cutl_timings_push(timings, timing);
+	}
+	fclose(input);
+
+	cutl_timings_sort(timings);
+}
+
+
+static void cutl_timings_read(Cutl_Globals *globals, const char *path)
+{
+	cutl_timings_load(&globals->history, path, CUTL_TIMINGS_FILE);
+	globals->plan_count = 0;
+}
+
+
+static void cutl_baseline_read(Cutl_Globals *globals, const char *path)
+{
+	cutl_timings_load(&globals->baseline, path, CUTL_BASELINE_FILE);
+}
+
+
+static void cutl_cache_read(Cutl_Globals *globals, const char *path)
+{
+	cutl_timings_load(&globals->cache, path, CUTL_CACHE_FILE);
+}
+
+
+// Must be called with the globals lock held.
+static void cutl_timings_plan(Cutl_Globals *globals, int count)
+{
+	if (globals->plan_count == count) return;
+
+	// Longest tests first, each to the shard with the least work so far.
+	Cutl_Timings *history = &globals->history;
+	Cutl_Timing **order = cutl_malloc(history->size * sizeof(*order));
+	for (size_t i=0; i<history->size; ++i) {
+		order[i] = &history->items[i];
+	}
+	qsort(order, history->size, sizeof(*order), cutl_timing_cmp_duration);
+
+	double *loads = cutl_calloc(count, sizeof(*loads));
+	for (size_t i=0; i<history->size; ++i) {
+		int shard = 0;
+		for (int j=1; j<count; ++j) {
+			if (loads[j] < loads[shard]) shard = j;
+		}
+		loads[shard] += order[i]->duration;
+		order[i]->shard = shard + 1;
+	}
+
+	free(loads);
+	free(order);
+	globals->plan_count = count;
+}
+
+
+static int cutl_timings_shard(Cutl_Globals *globals, uint32_t key, int count)
+{
+	int shard = 0;
+
+	cutl_lock(globals);
+	if (globals->history.size > 0) {
+		cutl_timings_plan(globals, count);
+		const Cutl_Timing timing = {.key = key};
+		const Cutl_Timing *found = bsearch(
+			&timing, globals->history.items, globals->history.size,
+			sizeof(timing), cutl_timing_cmp_key
+		);
+		if (found != NULL) shard = found->shard;
+	}
+	cutl_unlock(globals);
+
+	// Tests without history are sharded on their key alone.
+	return shard ? shard : (int) (key % count) + 1;
+}
+
+
+static size_t cutl_path(const Cutl *cutl, char *buffer)
+{
+	if (cutl->depth == 0) return 0;
+	if (cutl->name == NULL) return cutl_path(cutl->parent, buffer);
+
+	size_t size = cutl_path(cutl->parent, buffer);
+	if (size > 0) {
+		if (buffer) buffer[size] = '/';
+		size++;
+	}
+	const size_t length = strlen(cutl->name);
+	if (buffer) memcpy(buffer + size, cutl->name, length);
+
+	return size + length;
+}
+
+
+static char *cutl_path_dup(const Cutl *cutl)
+{
+	const size_t size = cutl_path(cutl, NULL);
+	char *name = cutl_malloc(size + 1);
+	cutl_path(cutl, name);
+	name[size] = '\0';
+
+	return name;
+}
+
+
+static void cutl_timings_record(
+	const Cutl *cutl, Cutl_Timings *timings, Cutl_Timing timing)
+{
+	timing.key = cutl->key;
+	timing.duration = cutl->duration;
+	timing.name = cutl_path_dup(cutl);
+
+	cutl_lock(cutl->globals);
+	cutl_timings_push(timings, timing);
+	cutl_unlock(cutl->globals);
+}
+
+
+static void cutl_timings_add(const Cutl *cutl)
+{
+	Cutl_Globals *globals = cutl->globals;
+	if (globals->timings_path != NULL) {
+		const Cutl_Timing timing = {0};
+		cutl_timings_record(cutl, &globals->measured, timing);
+	}
+	if (globals->cache_path != NULL) {
+		Cutl_Timing timing = {.status = cutl->failed ? 'F' : 'P'};
+#ifdef CUTL_INCREMENTAL_ENABLED
+		cutl_coverage_fingerprint(cutl, &timing);
+#endif
+		cutl_timings_record(cutl, &globals->results, timing);
+	}
+}
+
+
+// Keeps the slowest tests sorted, slowest first.
+static void cutl_slowest_add(const Cutl *cutl)
+{
+	Cutl_Globals *globals = cutl->globals;
+	Cutl_Timings *slowest = &globals->slowest;
+
+	cutl_lock(globals);
+	const size_t count = globals->slowest_count;
+	if (count == 0 || (slowest->size == count
+		&& slowest->items[count - 1].duration >= cutl->duration)
+	) {
+		cutl_unlock(globals);
+		return;
+	}
+
+	if (slowest->size == count) {
+		cutl_timing_free(&slowest->items[--slowest->size]);
+	}
+	const Cutl_Timing timing = {
+		.key = cutl->key, .duration = cutl->duration,
+		.name = cutl_path_dup(cutl),
+	};
+	cutl_timings_push(slowest, timing);
+
+	Cutl_Timing *items = slowest->items;
+	for (size_t i=slowest->size-1; i>0; --i) {
+		if (items[i - 1].duration >= items[i].duration) break;
+		const Cutl_Timing swap = items[i - 1];
+		items[i - 1] = items[i];
+		items[i] = swap;
+	}
+	cutl_unlock(globals);
+}
+
+
+// Tests run this time replace their history, the others keep it, unless
+// `keep_history` is true.
+static void cutl_timings_save(
+	Cutl *cutl, const char *kind, const char *path, Cutl_Timings *history,
+	Cutl_Timings *measured, bool keep_history)
+{
+	if (path == NULL) return;
+
+	FILE *output = fopen(path, "w");
+	if (output == NULL) {
+		cutl_message_at(
+			cutl, CUTL_WARN, "cutl_summary()", 0,
+			"Could not write %s file '%s' (%s).", kind, path,
+			strerror(errno)
+		);
+		return;
+	}
+
+	cutl_lock(cutl->globals);
+	cutl_timings_sort(measured);
+
+	const Cutl_Timing *new = measured->items, *old = history->items;
+	const Cutl_Timing *new_end = new + measured->size;
+	const Cutl_Timing *old_end = old + history->size;
+	while (new < new_end || old < old_end) {
+		const Cutl_Timing *timing;
+		if (old == old_end || (new < new_end && new->key < old->key)) {
+			timing = new++;
+		} else if (new == new_end || old->key < new->key) {
+			timing = old++;
+		} else {
+			timing = keep_history ? old : new;
+			old++, new++;
+		}
+
+		fprintf(
+			output, "%08lx %.6f", (unsigned long) timing->key,
+			timing->duration
+		);
+		if (timing->status != 0) {
+			fprintf(
+				output, " %c %08lx %d", timing->status,
+				(unsigned long) timing->fingerprint,
+				timing->nb_functions
+			);
+		}
+		for (int i=0; i<timing->nb_functions; ++i) {
+			const uint32_t function = timing->functions[i];
+			fprintf(output, " %08lx", (unsigned long) function);
+		}
+		if (timing->samples != NULL) {
+			fprintf(output, " %d", timing->nb_samples);
+			for (int i=0; i<timing->nb_samples; ++i) {
+				fprintf(output, " %.6f", timing->samples[i]);
+			}
+		}
+		fprintf(output, " %s\n", timing->name);
+	}
+	cutl_unlock(cutl->globals);
+
+	fclose(output);
+}
+
+
+static void cutl_timings_write(Cutl *cutl)
+{
+	Cutl_Globals *globals = cutl->globals;
+
+	cutl_timings_save(
+		cutl, "timings", globals->timings_path, &globals->history,
+		&globals->measured, false
+	);
+
+	// Baselines are only taken once, so that slowdowns don't add up.
+	cutl_timings_save(
+		cutl, "baseline", globals->baseline_path, &globals->baseline,
+		&globals->benched, true
+	);
+
+	cutl_timings_save(
+		cutl, "cache", globals->cache_path, &globals->cache,
+		&globals->results, false
+	);
+}
+
+
+
+// FILTERS
+
+// Matches the path against the glob pattern, or the path of one of its
+// parents. If `is_partial`, then it also returns whether the pattern could
+// match a test below the path.
+static bool cutl_glob(const char *pattern, const char *path, bool is_partial)
+{
+	for (; *pattern != '\0'; ++pattern, ++path) {
+		if (*pattern == '*') {
+			const bool is_deep = pattern[1] == '*';
+			pattern += is_deep ? 2 : 1;
+			for (;; ++path) {
+				if (cutl_glob(pattern, path, is_partial)) {
+					return true;
+				}
+				if (*path == '\0') return is_partial && is_deep;
+				if (*path == '/' && !is_deep) return false;
+			}
+		}
+
+		if (*path == '\0') return is_partial && *pattern == '/';
+		if (*pattern == '?' ? *path == '/' : *pattern != *path) {
+			return false;
+		}
+	}
+	return *path == '\0' || *path == '/';
+}
+
+
+// Tests are run if they match an included pattern, if any, and no excluded
+// one. Suites are run if any of their tests could match.
+static bool cutl_filter_check(
+	const Cutl *parent, const char *name, bool is_suite)
+{
+	const Cutl_Globals *globals = parent->globals;
+	if (globals->nb_filters == 0) return true;
+
+	const size_t size = cutl_path(parent, NULL);
+	char *path = cutl_malloc(size + strlen(name) + 2);
+	cutl_path(parent, path);
+	sprintf(path + size, size > 0 ? "/%s" : "%s", name);
+
+	bool has_included = false, is_included = false, is_excluded = false;
+	for (size_t i=0; i<globals->nb_filters && !is_excluded; ++i) {
+		const char *pattern = globals->filters[i].pattern;
+		if (globals->filters[i].is_excluded) {
+			is_excluded = cutl_glob(pattern, path, false);
+		} else if (!is_included) {
+			has_included = true;
+			is_included = cutl_glob(pattern, path, is_suite);
+		}
+	}
+	free(path);
+
+	return !is_excluded && (is_included || !has_included);
+}
+
+
+
+// SIGNALS
+
+#ifdef CUTL_USE_SIGACTION
+
+// Signal handlers need the innermost test run by the thread they interrupt.
+#ifdef CUTL_USE_PTHREAD
+static pthread_once_t cutl_signal_once = PTHREAD_ONCE_INIT;
+
+static pthread_key_t cutl_current_key;
+
+static pthread_key_t cutl_stack_key;
+
+
+static void cutl_stack_free(void *stack)
+{
+	const stack_t disabled = { .ss_flags = SS_DISABLE };
+	sigaltstack(&disabled, NULL);
+	free(stack);
+}
+
+
+static void cutl_signal_init(void)
+{
+	pthread_key_create(&cutl_current_key, NULL);
+	pthread_key_create(&cutl_stack_key, cutl_stack_free);
+}
+
+
+static Cutl *cutl_get_current(void)
+{
+	pthread_once(&cutl_signal_once, cutl_signal_init);
+	return pthread_getspecific(cutl_current_key);
+}
+
+
+static void cutl_set_current(Cutl *cutl)
+{
+	pthread_once(&cutl_signal_once, cutl_signal_init);
+	pthread_setspecific(cutl_current_key, cutl);
+}
+#else
+static Cutl *cutl_current;
+
+static void *cutl_stack;
+
+
+static Cutl *cutl_get_current(void)
+{
+	return cutl_current;
+}
+
+
+static void cutl_set_current(Cutl *cutl)
+{
+	cutl_current = cutl;
+}
+#endif
+
+
+// Crashes are handled on an alternate stack, in case the stack overflowed.
+static void cutl_stack_init(void)
+{
+#ifdef CUTL_USE_PTHREAD
+	if (pthread_getspecific(cutl_stack_key) != NULL) return;
+#else
+	if (cutl_stack != NULL) return;
+#endif
+
+	// Keep the stack of the thread, if it already has one.
+	stack_t stack;
+	if (sigaltstack(NULL, &stack) != 0 || !(stack.ss_flags & SS_DISABLE)) {
+		return;
+	}
+
+	stack.ss_sp = cutl_malloc(CUTL_STACK_SIZE);
+	stack.ss_size = CUTL_STACK_SIZE;
+	stack.ss_flags = 0;
+	if (sigaltstack(&stack, NULL) != 0) {
+		free(stack.ss_sp);
+		return;
+	}
+
+#ifdef CUTL_USE_PTHREAD
+	pthread_setspecific(cutl_stack_key, stack.ss_sp);
+#else
+	cutl_stack = stack.ss_sp;
+#endif
+}
+
+
+static const int cutl_crash_signals[] = {
+	SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT
+};
+
+enum { CUTL_NB_CRASH_SIGNALS = sizeof(cutl_crash_signals) / sizeof(int) };
+
+static struct sigaction cutl_crash_actions[CUTL_NB_CRASH_SIGNALS];
+
+
+static const char *cutl_signal_name(int sig)
+{
+	switch (sig) {
+	case SIGSEGV: return "SIGSEGV";
+	case SIGBUS: return "SIGBUS";
+	case SIGFPE: return "SIGFPE";
+	case SIGILL: return "SIGILL";
+	case SIGABRT: return "SIGABRT";
+	default: return "unknown";
+	}
+}
+
+
+// Jumps back to the test that crashed, unless it crashed inside the library
+// or isn't guarded, in which case the previous handler gets the signal.
+static void cutl_crash_handler(int sig)
+{
+	Cutl *cutl = cutl_get_current();
+	if (cutl != NULL && cutl->stage != 0 && cutl->settings.guard != 0) {
+		cutl->crashed = sig;
+		longjmp(cutl->env, cutl->stage);
+	}
+
+	for (int i=0; i<CUTL_NB_CRASH_SIGNALS; ++i) {
+		if (cutl_crash_signals[i] == sig) {
+			sigaction(sig, &cutl_crash_actions[i], NULL);
+		}
+	}
+	raise(sig);
+}
+
+
+static void cutl_crash_init(void)
+{
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = cutl_crash_handler;
+	action.sa_flags = SA_ONSTACK | SA_NODEFER;
+	sigemptyset(&action.sa_mask);
+
+	for (int i=0; i<CUTL_NB_CRASH_SIGNALS; ++i) {
+		const int sig = cutl_crash_signals[i];
+		sigaction(sig, &action, &cutl_crash_actions[i]);
+	}
+}
+
+
+static void cutl_crash_begin(const Cutl *cutl)
+{
+	if (cutl->settings.guard == 0) return;
+
+#ifdef CUTL_USE_PTHREAD
+	static pthread_once_t once = PTHREAD_ONCE_INIT;
+	pthread_once(&once, cutl_crash_init);
+#else
+	static bool is_init = false;
+	if (!is_init) {
+		cutl_crash_init();
+		is_init = true;
+	}
+#endif
+	cutl_stack_init();
+}
+
+
+// Reports the crash in the test that crashed.
+static void cutl_crash_check(Cutl *cutl)
+{
+	const int sig = cutl->crashed;
+	if (sig == 0) return;
+	cutl->crashed = 0;
+
+	cutl_message_at(
+		cutl, cutl->settings.guard, NULL, 0, "Crashed with signal %s.",
+		cutl_signal_name(sig)
+	);
+}
+
+#endif
+
+
+
+// TIMEOUTS
+
+// Units are flagged with the limit they reached, and the tests they run with
+// the same one when interrupted, until it is reported.
+enum {
+	CUTL_TIMED_OUT = 1,
+	CUTL_TIMED_OUT_CPU = 2,
+	CUTL_TIMED_OUT_REPORTED = 3,
+};
+
+
+// Tests are flagged by the watchdog thread.
+static int cutl_get_timed_out(const Cutl *cutl)
+{
+#ifdef CUTL_USE_PTHREAD
+	return __atomic_load_n(&cutl->timed_out, __ATOMIC_RELAXED);
+#else
+	return cutl->timed_out;
+#endif
+}
+
+
+static void cutl_set_timed_out(Cutl *cutl, int timed_out)
+{
+#ifdef CUTL_USE_PTHREAD
+	__atomic_store_n(&cutl->timed_out, timed_out, __ATOMIC_RELAXED);
+#else
+	cutl->timed_out = timed_out;
+#endif
+}
+
+
+static bool cutl_is_timed_out(const Cutl *cutl)
+{
+	for (; cutl != NULL; cutl = cutl->parent) {
+		if (cutl_get_timed_out(cutl)) return true;
+		if (cutl->is_unit) break;
+	}
+	return false;
+}
+
+
+static Cutl *cutl_get_unit(Cutl *cutl)
+{
+	for (Cutl *unit = cutl; unit != NULL; unit = unit->parent) {
+		if (unit->is_unit) return unit;
+	}
+	return cutl;
+}
+
+
+// Reports the timeout once, in the test that got interrupted.
+static void cutl_timeout_check(Cutl *cutl)
+{
+	const int timed_out = cutl_get_timed_out(cutl);
+	if (timed_out == 0 || timed_out == CUTL_TIMED_OUT_REPORTED) return;
+
+	Cutl *unit = cutl_get_unit(cutl);
+	cutl_set_timed_out(cutl, CUTL_TIMED_OUT_REPORTED);
+	cutl_set_timed_out(unit, CUTL_TIMED_OUT_REPORTED);
+
+	const bool is_cpu = timed_out == CUTL_TIMED_OUT_CPU;
+	const double elapsed = is_cpu
+		? cutl_cpu_time() - unit->cpu_duration
+		: cutl_time() - unit->started;
+	cutl_message_at(
+		cutl, CUTL_FAIL, NULL, 0, "Timed out after %.3f s%s.", elapsed,
+		is_cpu ? " (CPU)" : ""
+	);
+}
+
+
+#ifdef CUTL_TIMEOUT_ENABLED
+
+// Deadlines are 0 when there is no limit. The processor time is read from the
+// clock of the thread running the test.
+struct Cutl_Watch {
+	Cutl *cutl;
+	pthread_t thread;
+	clockid_t clock;
+	double deadline, cpu_deadline, expired, alarm;
+	bool has_clock, is_watched, is_expired, is_cpu;
+	Cutl_Watch *next;
+};
+
+struct Cutl_Watchdog {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t thread;
+	Cutl_Watch *first;
+	bool is_stopping;
+};
+
+
+static pthread_once_t cutl_timeout_once = PTHREAD_ONCE_INIT;
+
+
+// The watchdog signals the thread running the expired test, which jumps back
+// to the innermost test it is running, unless that one is inside the library.
+static void cutl_timeout_handler(int sig)
+{
+	Cutl *cutl = cutl_get_current();
+	if (cutl == NULL || cutl->stage == 0 || !cutl_is_timed_out(cutl)) {
+		return;
+	}
+
+	if (!cutl_get_timed_out(cutl)) {
+		const Cutl *unit = cutl_get_unit(cutl);
+		cutl_set_timed_out(cutl, cutl_get_timed_out(unit));
+	}
+	longjmp(cutl->env, cutl->stage);
+}
+
+
+static void cutl_timeout_init(void)
+{
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = cutl_timeout_handler;
+	action.sa_flags = SA_NODEFER;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGALRM, &action, NULL);
+}
+
+
+// Tests keep the first limit they reached.
+static void cutl_watchdog_expire(Cutl_Watch *watch, double now, bool is_cpu)
+{
+	if (!watch->is_expired) {
+		watch->is_expired = true;
+		watch->is_cpu = is_cpu;
+		watch->expired = now;
+	}
+
+	int timed_out = 0;
+	__atomic_compare_exchange_n(
+		&watch->cutl->timed_out, &timed_out,
+		watch->is_cpu ? CUTL_TIMED_OUT_CPU : CUTL_TIMED_OUT, false,
+		__ATOMIC_RELAXED, __ATOMIC_RELAXED
+	);
+
+	// Workers that don't come back are killed, their parent reports it.
+	if (watch->cutl->globals->is_worker
+		&& now >= watch->expired + CUTL_TIMEOUT_GRACE
+	) {
+		const int sig = watch->is_cpu ? SIGVTALRM : SIGALRM;
+		signal(sig, SIG_DFL);
+		kill(getpid(), sig);
+	}
+
+	pthread_kill(watch->thread, SIGALRM);
+	watch->alarm = now + CUTL_TIMEOUT_RETRY;
+}
+
+
+// Returns when the test must be checked again, or a negative value.
+static double cutl_watchdog_check(Cutl_Watch *watch, double now)
+{
+	if (watch->is_expired) {
+		if (now >= watch->alarm) {
+			cutl_watchdog_expire(watch, now, watch->is_cpu);
+		}
+		return watch->alarm;
+	}
+
+	if (watch->deadline > 0 && now >= watch->deadline) {
+		cutl_watchdog_expire(watch, now, false);
+		return watch->alarm;
+	}
+	double next = watch->deadline > 0 ? watch->deadline : -1;
+
+	struct timespec time;
+	if (watch->cpu_deadline > 0
+		&& clock_gettime(watch->clock, &time) == 0
+	) {
+		const double used = time.tv_sec + time.tv_nsec * 1e-9;
+		if (used >= watch->cpu_deadline) {
+			cutl_watchdog_expire(watch, now, true);
+			return watch->alarm;
+		}
+
+		// Threads can't use processor time faster than time passes.
+		const double wake = now + watch->cpu_deadline - used;
+		if (next < 0 || wake < next) next = wake;
+	}
+	return next;
+}
+
+
+static void *cutl_watchdog_main(void *data)
+{
+	Cutl_Watchdog *watchdog = data;
+
+	pthread_mutex_lock(&watchdog->lock);
+	while (!watchdog->is_stopping) {
+		const double now = cutl_time();
+		double next = -1;
+		Cutl_Watch *watch = watchdog->first;
+		for (; watch != NULL; watch = watch->next) {
+			const double wake = cutl_watchdog_check(watch, now);
+			if (wake >= 0 && (next < 0 || wake < next)) {
+				next = wake;
+			}
+		}
+
+		if (next < 0) {
+			pthread_cond_wait(&watchdog->cond, &watchdog->lock);
+		} else {
+			const struct timespec time = {
+				.tv_sec = (time_t) next,
+				.tv_nsec = (next - (time_t) next) * 1e9,
+			};
+			pthread_cond_timedwait(
+				&watchdog->cond, &watchdog->lock, &time
+			);
+		}
+	}
+	pthread_mutex_unlock(&watchdog->lock);
+
+	return NULL;
+}
+
+
+static Cutl_Watchdog *cutl_watchdog_get(Cutl_Globals *globals)
+{
+	cutl_lock(globals);
+	Cutl_Watchdog *watchdog = globals->watchdog;
+	if (watchdog == NULL) {
+		watchdog = cutl_calloc(1, sizeof(*watchdog));
+		pthread_mutex_init(&watchdog->lock, NULL);
+
+		// Deadlines are given by cutl_time().
+		pthread_condattr_t attr;
+		pthread_condattr_init(&attr);
+		pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+		pthread_cond_init(&watchdog->cond, &attr);
+		pthread_condattr_destroy(&attr);
+
+		if (pthread_create(
+			&watchdog->thread, NULL, cutl_watchdog_main, watchdog)
+		) {
+			pthread_cond_destroy(&watchdog->cond);
+			pthread_mutex_destroy(&watchdog->lock);
+			free(watchdog);
+			watchdog = NULL;
+		}
+		globals->watchdog = watchdog;
+	}
+	cutl_unlock(globals);
+
+	return watchdog;
+}
+
+
+static void cutl_watchdog_free(Cutl_Watchdog *watchdog)
+{
+	if (watchdog == NULL) return;
+
+	pthread_mutex_lock(&watchdog->lock);
+	watchdog->is_stopping = true;
+	pthread_cond_signal(&watchdog->cond);
+	pthread_mutex_unlock(&watchdog->lock);
+
+	pthread_join(watchdog->thread, NULL);
+	pthread_cond_destroy(&watchdog->cond);
+	pthread_mutex_destroy(&watchdog->lock);
+	free(watchdog);
+}
+
+
+// Deadlines count from the start of the test, even when it sets its own
+// timeouts while it runs.
+static void cutl_timeout_update(Cutl *cutl)
+{
+	Cutl_Watch *watch = cutl->watch;
+	const int timeout = cutl->settings.timeout;
+	const int cpu_timeout = watch->has_clock
+		? cutl->settings.cpu_timeout : 0;
+	if (!watch->is_watched && timeout <= 0 && cpu_timeout <= 0) return;
+
+	// The watchdog must not interrupt the test while it holds a lock.
+	Cutl *current = cutl_get_current();
+	const int stage = current ? current->stage : 0;
+	if (current) current->stage = 0;
+
+	pthread_once(&cutl_timeout_once, cutl_timeout_init);
+	Cutl_Watchdog *watchdog = cutl_watchdog_get(cutl->globals);
+	if (watchdog != NULL) {
+		pthread_mutex_lock(&watchdog->lock);
+		watch->deadline = timeout > 0
+			? cutl->started + timeout / 1000.0 : 0;
+		watch->cpu_deadline = cpu_timeout > 0
+			? cutl->cpu_duration + cpu_timeout / 1000.0 : 0;
+		if (!watch->is_watched) {
+			watch->next = watchdog->first;
+			watchdog->first = watch;
+			watch->is_watched = true;
+		}
+		pthread_cond_signal(&watchdog->cond);
+		pthread_mutex_unlock(&watchdog->lock);
+	}
+
+	if (current) current->stage = stage;
+}
+
+
+static void cutl_timeout_begin(Cutl *cutl, Cutl_Watch *watch)
+{
+	if (cutl->is_unit) {
+		watch->cutl = cutl;
+		watch->thread = pthread_self();
+		watch->has_clock = pthread_getcpuclockid(
+			watch->thread, &watch->clock
+		) == 0;
+		cutl->watch = watch;
+		cutl_timeout_update(cutl);
+	}
+}
+
+
+static void cutl_timeout_end(Cutl *cutl, Cutl_Watch *watch)
+{
+	cutl->watch = NULL;
+	if (watch->is_watched) {
+		Cutl_Watchdog *watchdog = cutl->globals->watchdog;
+		pthread_mutex_lock(&watchdog->lock);
+		Cutl_Watch **next = &watchdog->first;
+		while (*next != watch) {
+			next = &(*next)->next;
+		}
+		*next = watch->next;
+		pthread_mutex_unlock(&watchdog->lock);
+	}
+}
+
+#endif
+
+
+
+// HEAP ACCOUNTING
+
+#ifdef CUTL_HEAP_ENABLED
+
+CUTL_API void *__wrap_malloc(size_t size);
+CUTL_API void *__wrap_calloc(size_t count, size_t size);
+CUTL_API void *__wrap_realloc(void *ptr, size_t size);
+CUTL_API void __wrap_free(void *ptr);
+
+
+// Live blocks are kept in an open addressing table, keyed by address.
+static size_t cutl_heap_home(const Cutl_Heap *heap, uintptr_t address)
+{
+	return (address >> 4) * CUTL_HASH_PRIME & (heap->capacity - 1);
+}
+
+
+static size_t cutl_heap_slot(const Cutl_Heap *heap, uintptr_t address)
+{
+	size_t i = cutl_heap_home(heap, address);
+	while (heap->blocks[i].address != 0
+		&& heap->blocks[i].address != address
+	) {
+		i = (i + 1) & (heap->capacity - 1);
+	}
+	return i;
+}
+
+
+static bool cutl_heap_grow(Cutl_Heap *heap)
+{
+	const size_t capacity = heap->capacity > 0 ? heap->capacity * 2 : 64;
+	Cutl_Block *blocks = calloc(capacity, sizeof(*blocks));
+	if (blocks == NULL) return false;
+
+	const Cutl_Heap old = *heap;
+	heap->blocks = blocks;
+	heap->capacity = capacity;
+	for (size_t i=0; i<old.capacity; ++i) {
+		const Cutl_Block block = old.blocks[i];
+		if (block.address == 0) continue;
+		heap->blocks[cutl_heap_slot(heap, block.address)] = block;
+	}
+	free(old.blocks);
+	return true;
+}
+
+
+static void cutl_heap_insert(Cutl_Heap *heap, uintptr_t address, size_t size)
+{
+	if ((heap->count + 1) * 2 > heap->capacity && !cutl_heap_grow(heap)) {
+		return;
+	}
+
+	heap->blocks[cutl_heap_slot(heap, address)] = (Cutl_Block) {
+		address, size
+	};
+	heap->count++;
+	heap->nb_allocs++;
+	heap->bytes += size;
+	if (heap->bytes > heap->peak) {
+		heap->peak = heap->bytes;
+	}
+}
+
+
+static bool cutl_heap_remove(Cutl_Heap *heap, uintptr_t address)
+{
+	if (heap->capacity == 0) return false;
+
+	size_t hole = cutl_heap_slot(heap, address);
+	if (heap->blocks[hole].address == 0) return false;
+	heap->count--;
+	heap->bytes -= heap->blocks[hole].size;
+
+	// The blocks that follow are moved back into the hole, unless their
+	// home slot is after it.
+	const size_t mask = heap->capacity - 1;
+	size_t i = (hole + 1) & mask;
+	for (; heap->blocks[i].address != 0; i = (i + 1) & mask) {
+		const uintptr_t address = heap->blocks[i].address;
+		const size_t home = cutl_heap_home(heap, address);
+		if (((i - home) & mask) >= ((i - hole) & mask)) {
+			heap->blocks[hole] = heap->blocks[i];
+			hole = i;
+		}
+	}
+	heap->blocks[hole].address = 0;
+	return true;
+}
+
+
+// Allocations are accounted to the innermost test run by the thread, while
+// its functions are running.
+static void cutl_heap_track(uintptr_t address, size_t size)
+{
+	Cutl *cutl = cutl_get_current();
+	if (address == 0 || cutl == NULL || cutl->stage == 0
+		|| cutl->settings.leaks == 0
+	) {
+		return;
+	}
+
+	const int stage = cutl->stage;
+	cutl->stage = 0;
+	cutl_heap_insert(&cutl->heap, address, size);
+	cutl->stage = stage;
+}
+
+
+// Blocks may also be freed by the tests nested in the one that allocated
+// them, as long as they run on the same thread.
+static void cutl_heap_untrack(uintptr_t address)
+{
+	Cutl *current = cutl_get_current();
+	if (address == 0 || current == NULL) return;
+
+	const int stage = current->stage;
+	current->stage = 0;
+	for (Cutl *cutl = current; cutl != NULL; cutl = cutl->parent) {
+		if (cutl_heap_remove(&cutl->heap, address)) break;
+		if (cutl->parent != NULL
+			&& cutl->parent->is_threaded != cutl->is_threaded
+		) {
+			break;
+		}
+	}
+	current->stage = stage;
+}
+
+
+void *__wrap_malloc(size_t size)
+{
+	void *ptr = malloc(size);
+	cutl_heap_track((uintptr_t) ptr, size);
+	return ptr;
+}
+
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+	void *ptr = calloc(count, size);
+	cutl_heap_track((uintptr_t) ptr, count * size);
+	return ptr;
+}
+
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+	const uintptr_t address = (uintptr_t) ptr;
+	void *moved = realloc(ptr, size);
+
+	// Blocks that could not be moved are left as is, and still accounted.
+	if (moved == NULL && size > 0) return NULL;
+
+	cutl_heap_untrack(address);
+	cutl_heap_track((uintptr_t) moved, size);
+	return moved;
+}
+
+
+void __wrap_free(void *ptr)
+{
+	cutl_heap_untrack((uintptr_t) ptr);
+	free(ptr);
+}
+
+
+// Reports the blocks the test functions left allocated.
+static void cutl_heap_check(Cutl *cutl)
+{
+	Cutl_Heap *heap = &cutl->heap;
+	free(heap->blocks);
+	heap->blocks = NULL;
+	heap->capacity = 0;
+
+	if (heap->count == 0) return;
+	cutl_message_at(
+		cutl, cutl->settings.leaks, NULL, 0,
+		"Leaked %zu bytes in %zu allocation%s.", heap->bytes,
+		heap->count, heap->count > 1 ? "s" : ""
+	);
+}
+
+#endif
+
+
+static void cutl_heap_add(const Cutl *cutl)
+{
+	Cutl_Globals *globals = cutl->globals;
+	if (cutl->heap.peak == 0) return;
+
+	cutl_lock(globals);
+	if (cutl->heap.peak > globals->heap_peak) {
+		free(globals->heap_peak_name);
+		globals->heap_peak = cutl->heap.peak;
+		globals->heap_peak_name = cutl_path_dup(cutl);
+	}
+	cutl_unlock(globals);
+}
+
+
+
+// COVERAGE
+
+// Functions of the code under test call these hooks when they are entered and
+// left, once built with `-finstrument-functions`. They are defined whatever
+// the features, so that such programs always link.
+CUTL_API void __cyg_profile_func_enter(void *func, void *call_site);
+CUTL_API void __cyg_profile_func_exit(void *func, void *call_site);
+
+#ifdef CUTL_INCREMENTAL_ENABLED
+
+static uint32_t cutl_hash(uint32_t hash, const char *name);
+
+static bool cutl_in_unit(const Cutl *cutl);
+
+
+static size_t cutl_coverage_home(uintptr_t function, size_t capacity)
+{
+	return (function >> 4) * CUTL_HASH_PRIME & (capacity - 1);
+}
+
+
+static void cutl_coverage_add(Cutl_Coverage *coverage, uintptr_t function)
+{
+	if (2 * (coverage->count + 1) > coverage->capacity) {
+		const size_t capacity = coverage->capacity > 0
+			? 2 * coverage->capacity : 64;
+		uintptr_t *functions = cutl_calloc(
+			capacity, sizeof(*functions)
+		);
+
+		for (size_t i=0; i<coverage->capacity; ++i) {
+			const uintptr_t old = coverage->functions[i];
+			if (old == 0) continue;
+
+			size_t j = cutl_coverage_home(old, capacity);
+			while (functions[j] != 0) j = (j + 1) & (capacity - 1);
+			functions[j] = old;
+		}
+		free(coverage->functions);
+		coverage->functions = functions;
+		coverage->capacity = capacity;
+	}
+
+	const size_t mask = coverage->capacity - 1;
+	size_t i = cutl_coverage_home(function, coverage->capacity);
+	for (; coverage->functions[i] != 0; i = (i + 1) & mask) {
+		if (coverage->functions[i] == function) return;
+	}
+	coverage->functions[i] = function;
+	coverage->count++;
+}
+
+#endif
+
+
+// Functions are accounted to the innermost test run by the thread, while its
+// functions are running, as long as it is a unit or nested in one.
+void __cyg_profile_func_enter(void *func, void *call_site)
+{
+#ifdef CUTL_INCREMENTAL_ENABLED
+	Cutl *cutl = cutl_get_current();
+	if (cutl == NULL || cutl->stage == 0
+		|| !cutl->globals->is_incremental
+		|| (!cutl->is_unit && !cutl_in_unit(cutl))
+	) {
+		return;
+	}
+
+	cutl_coverage_add(&cutl->coverage, (uintptr_t) func);
+#endif
+}
+
+
+void __cyg_profile_func_exit(void *func, void *call_site)
+{
+}
+
+
+#ifdef CUTL_INCREMENTAL_ENABLED
+
+// Tests nested in a unit add the functions they covered to their parent.
+static void cutl_coverage_merge(Cutl *parent, const Cutl *cutl)
+{
+	const Cutl_Coverage *coverage = &cutl->coverage;
+	if (!cutl->is_unit) {
+		for (size_t i=0; i<coverage->capacity; ++i) {
+			const uintptr_t function = coverage->functions[i];
+			if (function != 0) {
+				cutl_coverage_add(&parent->coverage, function);
+			}
+		}
+	}
+	free(coverage->functions);
+}
+
+
+static void cutl_symbols_push(Cutl_Symbols *symbols, Cutl_Symbol symbol)
+{
+	if (symbols->count == symbols->capacity) {
+		symbols->capacity = symbols->capacity > 0
+			? 2 * symbols->capacity : 1024;
+		symbols->by_address = cutl_realloc(
+			symbols->by_address,
+			symbols->capacity * sizeof(*symbols->by_address)
+		);
+	}
+	symbols->by_address[symbols->count++] = symbol;
+}
+
+
+// Returns the contents of the section, null-terminated, or NULL.
+static void *cutl_section_read(FILE *input, const ElfW(Shdr) *section)
+{
+	if (fseek(input, section->sh_offset, SEEK_SET) != 0) return NULL;
+
+	char *data = cutl_malloc(section->sh_size + 1);
+	if (fread(data, 1, section->sh_size, input) != section->sh_size) {
+		free(data);
+		return NULL;
+	}
+	data[section->sh_size] = '\0';
+	return data;
+}
+
+
+// Adds the functions defined in the table of symbols, where they are loaded.
+static void cutl_symbols_read(
+	Cutl_Symbols *symbols, FILE *input, const ElfW(Shdr) *table,
+	const ElfW(Shdr) *strings, uintptr_t base)
+{
+	ElfW(Sym) *entries = cutl_section_read(input, table);
+	char *names = cutl_section_read(input, strings);
+	const size_t count = entries && names
+		? table->sh_size / sizeof(*entries) : 0;
+
+	for (size_t i=0; i<count; ++i) {
+		const ElfW(Sym) *entry = &entries[i];
+
+		// Symbol types are the same for both classes of files.
+		if (ELF64_ST_TYPE(entry->st_info) != STT_FUNC
+			|| entry->st_shndx == SHN_UNDEF || entry->st_size == 0
+			|| entry->st_name >= strings->sh_size
+		) {
+			continue;
+		}
+
+		const char *name = names + entry->st_name;
+		cutl_symbols_push(symbols, (Cutl_Symbol) {
+			.start = base + entry->st_value, .size = entry->st_size,
+			.name = cutl_hash(CUTL_HASH_BASIS, name),
+		});
+	}
+	free(entries);
+	free(names);
+}
+
+
+// Functions are read from the full table of symbols of each object loaded,
+// or from the dynamic one if it was stripped. The program comes first, and
+// is read from its file, being unnamed.
+static int cutl_symbols_load(struct dl_phdr_info *info, size_t size, void *data)
+{
+	Cutl_Symbols *symbols = data;
+	const char *path = info->dlpi_name;
+	if (!symbols->is_loaded) {
+		symbols->is_loaded = true;
+		if (path[0] == '\0') path = "/proc/self/exe";
+	}
+
+	FILE *input = path[0] != '\0' ? fopen(path, "rb") : NULL;
+	if (input == NULL) return 0;
+
+	ElfW(Ehdr) header;
+	if (fread(&header, sizeof(header), 1, input) != 1
+		|| memcmp(header.e_ident, ELFMAG, SELFMAG) != 0
+		|| header.e_shentsize != sizeof(ElfW(Shdr))
+		|| fseek(input, header.e_shoff, SEEK_SET) != 0
+	) {
+		fclose(input);
+		return 0;
+	}
+
+	const size_t nb_sections = header.e_shnum;
+	ElfW(Shdr) *sections = cutl_malloc(nb_sections * sizeof(*sections));
+	const ElfW(Shdr) *table = NULL;
+	if (fread(sections, sizeof(*sections), nb_sections, input)
+		== nb_sections
+	) {
+		for (size_t i=0; i<nb_sections; ++i) {
+			const ElfW(Shdr) *section = &sections[i];
+			if (section->sh_link >= nb_sections) continue;
+
+			if (section->sh_type == SHT_SYMTAB
+				|| (section->sh_type == SHT_DYNSYM && !table)
+			) {
+				table = section;
+			}
+		}
+	}
+	if (table != NULL) {
+		cutl_symbols_read(
+			symbols, input, table, &sections[table->sh_link],
+			info->dlpi_addr
+		);
+	}
+	free(sections);
+	fclose(input);
+	return 0;
+}
+
+
+static int cutl_symbol_cmp_address(const void *a, const void *b)
+{
+	const Cutl_Symbol *sa = a, *sb = b;
+	return (sa->start > sb->start) - (sa->start < sb->start);
+}
+
+
+static int cutl_symbol_cmp_name(const void *a, const void *b)
+{
+	const Cutl_Symbol *sa = a, *sb = b;
+	if (sa->name != sb->name) return sa->name < sb->name ? -1 : 1;
+	return cutl_symbol_cmp_address(a, b);
+}
+
+
+// Symbols are loaded when first needed, and kept for the whole run.
+static const Cutl_Symbols *cutl_symbols_get(Cutl_Globals *globals)
+{
+	Cutl_Symbols *symbols = &globals->symbols;
+
+	cutl_lock(globals);
+	if (!symbols->is_loaded) {
+		dl_iterate_phdr(cutl_symbols_load, symbols);
+		symbols->is_loaded = true;
+
+		const size_t size = symbols->count * sizeof(*symbols->by_name);
+		symbols->by_name = cutl_malloc(size);
+		if (size > 0) {
+			memcpy(symbols->by_name, symbols->by_address, size);
+		}
+		qsort(
+			symbols->by_address, symbols->count,
+			sizeof(*symbols->by_address), cutl_symbol_cmp_address
+		);
+		qsort(
+			symbols->by_name, symbols->count,
+			sizeof(*symbols->by_name), cutl_symbol_cmp_name
+		);
+	}
+	cutl_unlock(globals);
+
+	return symbols;
+}
+
+
+// Returns the function the address is in, or NULL.
+static const Cutl_Symbol *cutl_symbols_find(
+	const Cutl_Symbols *symbols, uintptr_t address)
+{
+	size_t low = 0, high = symbols->count;
+	while (low < high) {
+		const size_t middle = low + (high - low) / 2;
+		if (symbols->by_address[middle].start <= address) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	if (low == 0) return NULL;
+
+	const Cutl_Symbol *symbol = &symbols->by_address[low - 1];
+	return address - symbol->start < symbol->size ? symbol : NULL;
+}
+
+
+// FNV-1a hash of the code of the functions, by their names sorted. Returns
+// false if any of them is missing.
+static bool cutl_symbols_hash(
+	const Cutl_Symbols *symbols, const uint32_t *functions, int count,
+	uint32_t *fingerprint)
+{
+	uint32_t hash = CUTL_HASH_BASIS;
+	for (int i=0; i<count; ++i) {
+		size_t low = 0, high = symbols->count;
+		while (low < high) {
+			const size_t middle = low + (high - low) / 2;
+			if (symbols->by_name[middle].name < functions[i]) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+		if (low == symbols->count
+			|| symbols->by_name[low].name != functions[i]
+		) {
+			return false;
+		}
+
+		// Functions of the same name are all part of it.
+		for (; low < symbols->count
+			&& symbols->by_name[low].name == functions[i]; ++low
+		) {
+			const Cutl_Symbol *symbol = &symbols->by_name[low];
+			const unsigned char *code = (const void*) symbol->start;
+			for (size_t j=0; j<symbol->size; ++j) {
+				hash = (hash ^ code[j]) * CUTL_HASH_PRIME;
+			}
+		}
+	}
+
+	*fingerprint = hash;
+	return true;
+}
+
+
+static int cutl_function_cmp(const void *a, const void *b)
+{
+	const uint32_t x = *(const uint32_t*) a, y = *(const uint32_t*) b;
+	return (x > y) - (x < y);
+}
+
+
+// Names the functions the unit covered and fingerprints their code, unless
+// it entered any function without a symbol.
+static void cutl_coverage_fingerprint(const Cutl *cutl, Cutl_Timing *timing)
+{
+	const Cutl_Coverage *coverage = &cutl->coverage;
+	if (coverage->count == 0) return;
+
+	const Cutl_Symbols *symbols = cutl_symbols_get(cutl->globals);
+	uint32_t *functions = cutl_malloc(
+		coverage->count * sizeof(*functions)
+	);
+	int count = 0;
+	for (size_t i=0; i<coverage->capacity; ++i) {
+		if (coverage->functions[i] == 0) continue;
+
+		const Cutl_Symbol *symbol = cutl_symbols_find(
+			symbols, coverage->functions[i]
+		);
+		if (symbol == NULL) {
+			free(functions);
+			return;
+		}
+		functions[count++] = symbol->name;
+	}
+
+	qsort(functions, count, sizeof(*functions), cutl_function_cmp);
+	int nb_functions = 0;
+	for (int i=0; i<count; ++i) {
+		if (i == 0 || functions[i] != functions[i - 1]) {
+			functions[nb_functions++] = functions[i];
+		}
+	}
+
+	if (!cutl_symbols_hash(
+		symbols, functions, nb_functions, &timing->fingerprint)
+	) {
+		free(functions);
+		return;
+	}
+	timing->nb_functions = nb_functions;
+	timing->functions = functions;
+}
+
+
+// Tests are unchanged if they passed last time, and the code of the functions
+// they covered is still the same.
+static bool cutl_coverage_unchanged(Cutl_Globals *globals, uint32_t key)
+{
+	if (globals->cache.size == 0) return false;
+
+	const Cutl_Timing timing = {.key = key};
+	const Cutl_Timing *found = bsearch(
+		&timing, globals->cache.items, globals->cache.size,
+		sizeof(timing), cutl_timing_cmp_key
+	);
+	if (found == NULL || found->status != 'P'
+		|| found->nb_functions == 0
+	) {
+		return false;
+	}
+
+	uint32_t fingerprint;
+	return cutl_symbols_hash(
+		cutl_symbols_get(globals), found->functions,
+		found->nb_functions, &fingerprint
+	) && fingerprint == found->fingerprint;
+}
+
+#endif
+
+
+
+// COUNTERS
+
+enum { CUTL_NB_COUNTERS = 4 };
+
+// Events of the calling thread, counted as a group so that they are all
+// counted at the same time.
+typedef struct {
+	int nb_events;
+	int fds[CUTL_NB_COUNTERS];
+	bool is_software;
+} Cutl_Counters;
+
+
+#ifdef CUTL_USE_PERF_EVENT
+
+static const uint64_t cutl_hardware_events[] = {
+	PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+static const uint64_t cutl_software_events[] = {
+	PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_SW_PAGE_FAULTS,
+	PERF_COUNT_SW_CONTEXT_SWITCHES,
+};
+
+
+static void cutl_counters_close(Cutl_Counters *counters)
+{
+	for (int i=0; i<counters->nb_events; ++i) {
+		close(counters->fds[i]);
+	}
+	counters->nb_events = 0;
+}
+
+
+static bool cutl_counters_group(
+	Cutl_Counters *counters, uint32_t type, const uint64_t *events,
+	int nb_events)
+{
+	for (int i=0; i<nb_events; ++i) {
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = events[i];
+		attr.disabled = i == 0;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP
+			| PERF_FORMAT_TOTAL_TIME_ENABLED
+			| PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		const int leader = i == 0 ? -1 : counters->fds[0];
+		const long fd = syscall(
+			SYS_perf_event_open, &attr, 0, -1, leader,
+			PERF_FLAG_FD_CLOEXEC
+		);
+		if (fd == -1) {
+			cutl_counters_close(counters);
+			return false;
+		}
+		counters->fds[counters->nb_events++] = fd;
+	}
+	return true;
+}
+
+
+// Falls back to software events when hardware ones are not available, as in
+// virtual machines or when restricted by `perf_event_paranoid`.
+static void cutl_counters_open(Cutl_Counters *counters)
+{
+	const int nb_hardware = sizeof(cutl_hardware_events) / sizeof(uint64_t);
+	const int nb_software = sizeof(cutl_software_events) / sizeof(uint64_t);
+
+	counters->is_software = !cutl_counters_group(
+		counters, PERF_TYPE_HARDWARE, cutl_hardware_events, nb_hardware
+	) && cutl_counters_group(
+		counters, PERF_TYPE_SOFTWARE, cutl_software_events, nb_software
+	);
+}
+
+
+static void cutl_counters_start(Cutl_Counters *counters)
+{
+	if (counters->nb_events == 0) return;
+
+	ioctl(counters->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(counters->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+
+// Returns false if the events could not be counted. Counts are scaled up when
+// the events had to share the hardware with others.
+static bool cutl_counters_stop(Cutl_Counters *counters, double *values)
+{
+	if (counters->nb_events == 0) return false;
+
+	ioctl(counters->fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+	uint64_t group[3 + CUTL_NB_COUNTERS];
+	const ssize_t size = read(counters->fds[0], group, sizeof(group));
+	const ssize_t expected = (3 + counters->nb_events) * sizeof(uint64_t);
+	if (size != expected || group[2] == 0) return false;
+
+	const double scale = (double) group[1] / group[2];
+	for (int i=0; i<counters->nb_events; ++i) {
+		values[i] = group[3 + i] * scale;
+	}
+	return true;
+}
+
+
+static void cutl_counters_report(
+	Cutl *cutl, const Cutl_Counters *counters, const double *values,
+	double calls)
+{
+	if (counters->is_software) {
+		cutl_message_at(
+			cutl, CUTL_INFO, NULL, 0,
+			"%.2f task-clock ns/op, %.3f page faults/op, %.3f"
+			" context switches/op.", values[0] / calls,
+			values[1] / calls, values[2] / calls
+		);
+		return;
+	}
+
+	cutl_message_at(
+		cutl, CUTL_INFO, NULL, 0,
+		"%.2f cycles/op, %.2f instructions/op (IPC %.2f), %.3f cache"
+		" misses/op, %.3f branch misses/op.", values[0] / calls,
+		values[1] / calls, values[0] > 0 ? values[1] / values[0] : 0.0,
+		values[2] / calls, values[3] / calls
+	);
+}
+
+#endif
+
+
+
+// BENCHMARKS
+
+// Returns the time taken to call the function `count` times in a row.
+static double cutl_bench_sample(Cutl *cutl, Cutl_Func *func, long count)
+{
+	void *data = cutl->test_data;
+	const double start = cutl_time();
+	for (long i=0; i<count; ++i) {
+		func(cutl, data);
+	}
+	return cutl_time() - start;
+}
+
+
+// Returns the number of calls needed for a sample to last long enough to be
+// measured, predicted from the last sample but growing at most a hundredfold.
+static long cutl_bench_calibrate(Cutl *cutl, Cutl_Func *func)
+{
+	long count = 1;
+	for (;;) {
+		const double elapsed = cutl_bench_sample(cutl, func, count);
+		if (elapsed >= CUTL_BENCH_TIME || count > LONG_MAX / 100) {
+			return count;
+		}
+
+		double next = 100.0 * count;
+		if (elapsed > 0) {
+			const double predicted = 1.2 * CUTL_BENCH_TIME * count
+				/ elapsed;
+			if (predicted < next) next = predicted;
+		}
+		count = next > count ? (long) next : count + 1;
+	}
+}
+
+
+static int cutl_double_cmp(const void *a, const void *b)
+{
+	const double x = *(const double*) a, y = *(const double*) b;
+	return (x > y) - (x < y);
+}
+
+
+// One-sided Mann-Whitney U test, with the normal approximation: returns the
+// probability of the samples being at least this much larger than those of
+// the baseline if they were not.
+static double cutl_mann_whitney(
+	const double *samples, int nb_samples, const double *baseline,
+	int nb_baseline)
+{
+	double u = 0.0;
+	for (int i=0; i<nb_samples; ++i) {
+		for (int j=0; j<nb_baseline; ++j) {
+			if (samples[i] > baseline[j]) {
+				u += 1.0;
+			} else if (samples[i] == baseline[j]) {
+				u += 0.5;
+			}
+		}
+	}
+
+	const double n = (double) nb_samples * nb_baseline;
+	const double deviation = sqrt(
+		n * (nb_samples + nb_baseline + 1) / 12.0
+	);
+	const double z = (u - n / 2.0 - 0.5) / deviation;
+
+	return 0.5 * erfc(z / sqrt(2.0));
+}
+
+
+// Fails the benchmark if it is significantly slower than its baseline.
+static void cutl_bench_compare(
+	Cutl *cutl, const double *samples, double median)
+{
+	Cutl_Globals *globals = cutl->globals;
+	double baseline[CUTL_BENCH_SAMPLES];
+	int nb_baseline = 0;
+	double baseline_median = 0.0;
+
+	cutl_lock(globals);
+	const Cutl_Timing timing = {.key = cutl->key};
+	const Cutl_Timing *found = globals->baseline.size == 0 ? NULL : bsearch(
+		&timing, globals->baseline.items, globals->baseline.size,
+		sizeof(timing), cutl_timing_cmp_key
+	);
+	if (found != NULL) {
+		nb_baseline = found->nb_samples;
+		memcpy(baseline, found->samples, nb_baseline * sizeof(double));
+		baseline_median = found->duration;
+	}
+	cutl_unlock(globals);
+
+	if (nb_baseline < 2 || baseline_median <= 0) return;
+
+	const double p = cutl_mann_whitney(
+		samples, CUTL_BENCH_SAMPLES, baseline, nb_baseline
+	);
+	const double slowdown = 100.0 * (median / baseline_median - 1.0);
+	if (p < CUTL_BENCH_ALPHA && slowdown > cutl->settings.regression) {
+		cutl_message_at(
+			cutl, CUTL_FAIL, NULL, 0,
+			"Slower than baseline by %.1f%% (p = %.4f).", slowdown,
+			p
+		);
+	}
+}
+
+
+static void cutl_bench_add(
+	const Cutl *cutl, const double *samples, double median)
+{
+	Cutl_Globals *globals = cutl->globals;
+	if (globals->baseline_path == NULL) return;
+
+	Cutl_Timing timing = {
+		.key = cutl->key,
+		.duration = median,
+		.nb_samples = CUTL_BENCH_SAMPLES,
+		.samples = cutl_malloc(CUTL_BENCH_SAMPLES * sizeof(double)),
+		.name = cutl_path_dup(cutl),
+	};
+	memcpy(timing.samples, samples, CUTL_BENCH_SAMPLES * sizeof(double));
+
+	cutl_lock(globals);
+	cutl_timings_push(&globals->benched, timing);
+	cutl_unlock(globals);
+}
+
+
+// The counters are closed by the caller, in case the benchmark fails.
+static void cutl_bench_execute(
+	Cutl *cutl, Cutl_Func *func, Cutl_Counters *counters)
+{
+	const long count = cutl_bench_calibrate(cutl, func);
+
+	// Timeouts must not interrupt the test while it holds resources.
+	int stage = cutl->stage;
+#ifdef CUTL_USE_PERF_EVENT
+	if (cutl->settings.has_counters) {
+		cutl->stage = 0;
+		cutl_counters_open(counters);
+		cutl->stage = stage;
+	}
+	cutl_counters_start(counters);
+#endif
+
+	// Nanoseconds per call.
+	double samples[CUTL_BENCH_SAMPLES];
+	double mean = 0.0;
+	for (int i=0; i<CUTL_BENCH_SAMPLES; ++i) {
+		samples[i] = cutl_bench_sample(cutl, func, count) * 1e9 / count;
+		mean += samples[i] / CUTL_BENCH_SAMPLES;
+	}
+
+	stage = cutl->stage;
+	cutl->stage = 0;
+#ifdef CUTL_USE_PERF_EVENT
+	double values[CUTL_NB_COUNTERS];
+	const bool has_values = cutl_counters_stop(counters, values);
+#endif
+
+	qsort(samples, CUTL_BENCH_SAMPLES, sizeof(double), cutl_double_cmp);
+
+	double variance = 0.0;
+	for (int i=0; i<CUTL_BENCH_SAMPLES; ++i) {
+		const double diff = samples[i] - mean;
+		variance += diff * diff / (CUTL_BENCH_SAMPLES - 1);
+	}
+
+	const int middle = CUTL_BENCH_SAMPLES / 2;
+	const double median = CUTL_BENCH_SAMPLES % 2 != 0 ? samples[middle]
+		: (samples[middle - 1] + samples[middle]) / 2;
+
+	cutl_message_at(
+		cutl, CUTL_INFO, NULL, 0,
+		"%.2f ns/op (median %.2f, stddev %.2f, min %.2f) over %d x %ld"
+		" calls.", mean, median, sqrt(variance), samples[0],
+		CUTL_BENCH_SAMPLES, count
+	);
+#ifdef CUTL_USE_PERF_EVENT
+	if (has_values) {
+		const double calls = (double) CUTL_BENCH_SAMPLES * count;
+		cutl_counters_report(cutl, counters, values, calls);
+	}
+#endif
+
+	cutl_bench_compare(cutl, samples, median);
+	cutl_bench_add(cutl, samples, median);
+
+	cutl->stage = stage;
+}
+
+
+
+// TESTING
+
+void cutl_at_start(Cutl *cutl, Cutl_Func *func, void *data)
+{
+	assert(cutl != NULL);
+
+	cutl->start = func;
+	cutl->start_data = data;
+}
+
+
+void cutl_at_end(Cutl *cutl, Cutl_Func *func, void *data)
+{
+	assert(cutl != NULL);
+
+	cutl->end = func;
+	cutl->end_data = data;
+}
+
+
+void cutl_at_interrupt(Cutl *cutl, Cutl_Func *func, void *data)
+{
+	assert(cutl != NULL);
+
+	cutl->interrupt = func;
+	cutl->interrupt_data = data;
+}
+
+
+// Reports the signals received while the test functions were running.
+static void cutl_signal_check(Cutl *cutl)
+{
+#ifdef CUTL_USE_SIGACTION
+	cutl_crash_check(cutl);
+#endif
+	cutl_timeout_check(cutl);
+}
+
+
+static void cutl_execute(Cutl *cutl, const Cutl_Task *task)
+{
+	// Locals could be clobbered by longjmp(), so the processor time holds
+	// its start until the test is done.
+	cutl->started = cutl_time();
+	cutl->cpu_duration = cutl_cpu_time();
+	cutl_report_start(cutl);
+#ifdef CUTL_USE_SIGACTION
+	Cutl *previous = cutl_get_current();
+	cutl_set_current(cutl);
+	cutl_crash_begin(cutl);
+#endif
+#ifdef CUTL_TIMEOUT_ENABLED
+	Cutl_Watch watch = {0};
+	cutl_timeout_begin(cutl, &watch);
+#endif
+	Cutl_Counters counters = {0};
+
+	// Testing
+	if (task->start) {
+		if (setjmp(cutl->env) == 0) {
+			cutl->stage = CUTL_STAGE_BEFORE;
+			task->start(cutl, task->start_data);
+		}
+		cutl->stage = 0;
+		cutl_signal_check(cutl);
+	}
+
+	if (!cutl->failed) {
+		if (setjmp(cutl->env) == 0) {
+			cutl->stage = CUTL_STAGE_TESTING;
+			if (task->is_bench) {
+				cutl_bench_execute(cutl, task->test, &counters);
+			} else {
+				task->test(cutl, cutl->test_data);
+			}
+		}
+		cutl->stage = 0;
+#ifdef CUTL_USE_PERF_EVENT
+		cutl_counters_close(&counters);
+#endif
+		cutl_join(cutl);
+		cutl_signal_check(cutl);
+		if (task->end) {
+			if (setjmp(cutl->env) == 0) {
+				cutl->stage = CUTL_STAGE_AFTER;
+				task->end(cutl, task->end_data);
+			}
+			cutl->stage = 0;
+			cutl_signal_check(cutl);
+		}
+	}
+	cutl_join(cutl);
+#ifdef CUTL_HEAP_ENABLED
+	cutl_heap_check(cutl);
+#endif
+	cutl_arena_free(cutl);
+	cutl->duration = cutl_time() - cutl->started;
+	cutl->cpu_duration = cutl_cpu_time() - cutl->cpu_duration;
+
+#ifdef CUTL_TIMEOUT_ENABLED
+	cutl_timeout_end(cutl, &watch);
+#endif
+#ifdef CUTL_USE_SIGACTION
+	cutl_set_current(previous);
+#endif
+
+	// Reporting
+	if (cutl->is_prefixed
+		|| (cutl->nb_children == 0 && CUTL_VERBCHECK(cutl, CUTL_TESTS))
+		|| (cutl->nb_children != 0 && CUTL_VERBCHECK(cutl, CUTL_SUITES))
+	) {
+		cutl_prefix(cutl);
+		cutl_suffix(cutl);
+	}
+	cutl_report_end(cutl);
+	free(cutl->line.data);
+	cutl->line = (Cutl_Buffer) {0};
+}
+
+
+static void cutl_merge(Cutl *parent, const Cutl *cutl)
+{
+	// Suites whose tests were all skipped only count if they failed.
+	const bool is_leaf = cutl->nb_children == 0 && cutl->name != NULL
+		&& (cutl->nb_skipped == 0 || cutl->failed);
+
+	if (cutl->name != NULL) {
+		cutl_heap_add(cutl);
+	}
+
+	if (is_leaf) {
+		cutl_slowest_add(cutl);
+		parent->nb_children++;
+		if (cutl->failed) {
+			parent->nb_failed++;
+		} else {
+			parent->nb_passed++;
+		}
+	} else {
+		parent->nb_children += cutl->nb_children;
+		parent->nb_passed += cutl->nb_passed;
+		parent->nb_failed += cutl->nb_failed;
+	}
+	parent->nb_skipped += cutl->nb_skipped;
+
+	if (cutl->is_unit) {
+		cutl_timings_add(cutl);
+	}
+#ifdef CUTL_INCREMENTAL_ENABLED
+	cutl_coverage_merge(parent, cutl);
+#endif
+
+	if (cutl->failed) parent->failed = true;
+	if (cutl->error) {
+		parent->error = true;
+	}
+}
+
+
+
+// PARALLEL JOBS
+
+#if defined(CUTL_USE_FORK) || defined(CUTL_USE_PTHREAD)
+static void cutl_job_attach(Cutl_Job *job)
+{
+	// Replay the parent prefix as if the test had not been detached.
+	Cutl *cutl = &job->cutl;
+	cutl->is_detached = false;
+	if (cutl->is_prefixed) {
+		cutl_prefix_parent(cutl);
+	}
+}
+#endif
+
+
+#ifdef CUTL_USE_FORK
+
+#define CUTL_JOB_MAGIC 0x4355544c
+
+typedef struct {
+	int magic;
+	bool failed, error;
+	int nb_children, nb_passed, nb_failed;
+	double duration, cpu_duration;
+	size_t heap_count, heap_bytes, heap_peak, heap_allocs;
+	bool is_prefixed, is_infixed;
+	size_t report_sizes[CUTL_NB_REPORTS], coverage_size;
+} Cutl_Job_Result;
+
+
+#ifdef CUTL_USE_MMAP
+
+// Workers write their output and result in a slot of memory shared with the
+// parent, instead of a temporary file. Jobs are always joined in the order
+// they were forked, so slots are taken and given back as a ring.
+struct Cutl_Slot {
+	Cutl_Job_Result result;
+	size_t size;
+	char output[];
+};
+
+struct Cutl_Ring {
+	char *memory;
+	int first, count;
+};
+
+#define CUTL_SLOT_CAPACITY (CUTL_SLOT_SIZE - sizeof(Cutl_Slot))
+
+
+// Returns NULL if all slots are taken.
+static Cutl_Slot *cutl_ring_take(Cutl_Globals *globals)
+{
+	Cutl_Ring *ring = globals->ring;
+	if (ring == NULL) {
+		void *memory = mmap(
+			NULL, (size_t) CUTL_RING_SLOTS * CUTL_SLOT_SIZE,
+			PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+			-1, 0
+		);
+		if (memory == MAP_FAILED) return NULL;
+
+		ring = cutl_calloc(1, sizeof(*ring));
+		ring->memory = memory;
+		globals->ring = ring;
+	}
+
+	if (ring->count == CUTL_RING_SLOTS) return NULL;
+
+	const int index = (ring->first + ring->count) % CUTL_RING_SLOTS;
+	ring->count++;
+
+	Cutl_Slot *slot = (Cutl_Slot*) (
+		ring->memory + (size_t) index * CUTL_SLOT_SIZE
+	);
+	slot->result.magic = 0;
+	slot->output[0] = '\0';
+	return slot;
+}
+
+
+// Gives back the oldest slot, or the newest one if `is_newest` is true.
+static void cutl_ring_give(Cutl_Globals *globals, bool is_newest)
+{
+	Cutl_Ring *ring = globals->ring;
+	if (!is_newest) {
+		ring->first = (ring->first + 1) % CUTL_RING_SLOTS;
+	}
+	ring->count--;
+}
+
+
+static void cutl_ring_free(Cutl_Ring *ring)
+{
+	if (ring == NULL) return;
+
+	munmap(ring->memory, (size_t) CUTL_RING_SLOTS * CUTL_SLOT_SIZE);
+	free(ring);
+}
+
+#endif
+
+
+static void cutl_job_wait(Cutl_Job *job, int options)
+{
+	if (job->is_done) return;
+
+	pid_t pid;
+	do {
+		pid = waitpid(job->pid, &job->status, options);
+	} while (pid == -1 && errno == EINTR);
+
+	if (pid == job->pid || pid == -1) {
+		job->is_done = true;
+		job->cutl.globals->nb_workers--;
+	}
+}
+
+
+static void cutl_job_wait_any(Cutl *parent)
+{
+	for (;;) {
+		for (Cutl_Job *job = parent->first_job; job; job = job->next) {
+			if (!job->is_forked || job->is_done) continue;
+			cutl_job_wait(job, WNOHANG);
+			if (job->is_done) return;
+		}
+
+		// Sleep until any child process exits, without reaping it.
+		siginfo_t info = {0};
+		if (waitid(P_ALL, 0, &info, WEXITED | WNOWAIT) == -1
+			&& errno == EINTR) continue;
+
+		bool is_job = false;
+		for (Cutl_Job *job = parent->first_job; job; job = job->next) {
+			is_job = is_job || (job->is_forked && !job->is_done
+				&& job->pid == info.si_pid);
+		}
+
+		// Someone else's child: fall back to the oldest running job.
+		if (!is_job) {
+			Cutl_Job *job = parent->first_job;
+			for (; job != NULL; job = job->next) {
+				if (!job->is_forked || job->is_done) continue;
+				cutl_job_wait(job, 0);
+				return;
+			}
+			return;
+		}
+	}
+}
+
+
+// Runs the test in the worker, then sends its result to the parent.
+CUTL_NORETURN static void cutl_job_run(Cutl_Job *job)
+{
+	Cutl *cutl = &job->cutl;
+	Cutl_Globals *globals = cutl->globals;
+	globals->is_worker = true;
+	globals->is_server = cutl->is_server;
+	globals->nb_workers = 0;
+
+	// Only the copies are freed: the thread and slots are the parent's.
+	free(globals->watchdog);
+	globals->watchdog = NULL;
+	free(globals->ring);
+	globals->ring = NULL;
+#ifdef CUTL_USE_PTHREAD
+	if (globals->reporter != NULL) {
+		free(globals->reporter->data);
+		free(globals->reporter);
+		globals->reporter = NULL;
+	}
+#endif
+
+#ifdef CUTL_USE_MMAP
+	if (job->slot != NULL) {
+		job->output = fmemopen(
+			job->slot->output, CUTL_SLOT_CAPACITY, "w"
+		);
+		if (job->output == NULL) _exit(EXIT_FAILURE);
+
+		// Unbuffered, so that the output survives a crash.
+		setvbuf(job->output, NULL, _IONBF, 0);
+	}
+#endif
+	cutl->settings.output = job->output;
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		if (cutl_report_file(cutl, i) == NULL) continue;
+
+		cutl->reports[i] = open_memstream(
+			&job->report_buffers[i], &job->report_sizes[i]
+		);
+		if (cutl->reports[i] == NULL) _exit(EXIT_FAILURE);
+	}
+
+	cutl_execute(cutl, &job->task);
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		if (cutl->reports[i] != NULL) fclose(cutl->reports[i]);
+	}
+
+	Cutl_Job_Result result = {
+		.magic = CUTL_JOB_MAGIC,
+		.failed = cutl->failed, .error = cutl->error,
+		.nb_children = cutl->nb_children,
+		.nb_passed = cutl->nb_passed,
+		.nb_failed = cutl->nb_failed,
+		.duration = cutl->duration,
+		.cpu_duration = cutl->cpu_duration,
+		.heap_count = cutl->heap.count,
+		.heap_bytes = cutl->heap.bytes,
+		.heap_peak = cutl->heap.peak,
+		.heap_allocs = cutl->heap.nb_allocs,
+		.is_prefixed = cutl->is_prefixed,
+		.is_infixed = cutl->is_infixed,
+	};
+
+	fflush(stdout);
+	fflush(stderr);
+	fflush(job->output);
+
+	// Reports follow the output, unless they don't fit whole.
+	size_t room = SIZE_MAX;
+#ifdef CUTL_USE_MMAP
+	if (job->slot != NULL) {
+		const long end = ftell(job->output);
+		room = end >= 0 ? CUTL_SLOT_CAPACITY - end : 0;
+	}
+#endif
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		const size_t size = job->report_sizes[i];
+		if (size == 0 || size > room) continue;
+
+		fwrite(job->report_buffers[i], 1, size, job->output);
+		fflush(job->output);
+		result.report_sizes[i] = size;
+		room -= size;
+	}
+
+	// So do the functions the test covered.
+	const Cutl_Coverage *coverage = &cutl->coverage;
+	const size_t coverage_size = coverage->count * sizeof(uintptr_t);
+	if (coverage_size > 0 && coverage_size <= room) {
+		for (size_t i=0; i<coverage->capacity; ++i) {
+			const uintptr_t function = coverage->functions[i];
+			if (function == 0) continue;
+
+			fwrite(&function, sizeof(function), 1, job->output);
+		}
+		fflush(job->output);
+		result.coverage_size = coverage_size;
+	}
+#ifdef CUTL_USE_MMAP
+	if (job->slot != NULL) {
+		// Output that didn't fit is lost.
+		const long size = ftell(job->output);
+		job->slot->size = size < 0 ? 0
+			: (size_t) size < CUTL_SLOT_CAPACITY ? (size_t) size
+			: CUTL_SLOT_CAPACITY;
+		job->slot->result = result;
+		_exit(EXIT_SUCCESS);
+	}
+#endif
+	fwrite(&result, sizeof(result), 1, job->output);
+	fflush(job->output);
+	_exit(EXIT_SUCCESS);
+}
+
+
+static bool cutl_job_fork(Cutl *parent, Cutl_Job *job)
+{
+	Cutl_Globals *globals = parent->globals;
+
+	const int jobs = parent->settings.jobs;
+	while (globals->nb_workers >= jobs) {
+		cutl_job_wait_any(parent);
+	}
+	cutl_join_done(parent);
+	if (parent->error) return false;
+
+#ifdef CUTL_USE_MMAP
+	job->slot = cutl_ring_take(globals);
+#endif
+	if (job->slot == NULL) {
+		job->output = tmpfile();
+		if (job->output == NULL) return false;
+	}
+
+	// Nothing buffered should be written twice, as by workers calling
+	// exit(), reports of other trees of tests included.
+	cutl_drain(parent);
+	fflush(NULL);
+
+	job->pid = fork();
+	if (job->pid == -1) {
+#ifdef CUTL_USE_MMAP
+		if (job->slot != NULL) cutl_ring_give(globals, true);
+#endif
+		if (job->output != NULL) fclose(job->output);
+		return false;
+	}
+
+	if (job->pid == 0) {
+		cutl_job_run(job);
+	}
+
+	job->cutl.started = cutl_time();
+	job->is_forked = true;
+	globals->nb_workers++;
+	return true;
+}
+
+
+// Reads the result appended to the worker's output, returns the size of the
+// output without it.
+static long cutl_job_read(Cutl_Job *job, Cutl_Job_Result *result)
+{
+#ifdef CUTL_USE_MMAP
+	if (job->slot != NULL) {
+		// Workers that died still kept their output null-terminated.
+		*result = job->slot->result;
+		if (result->magic != CUTL_JOB_MAGIC) {
+			return strnlen(job->slot->output, CUTL_SLOT_CAPACITY);
+		}
+		return job->slot->size;
+	}
+#endif
+
+	long size = 0;
+	if (fseek(job->output, 0, SEEK_END) == 0) {
+		size = ftell(job->output);
+	}
+	if (size >= (long) sizeof(*result)
+		&& fseek(job->output, -(long) sizeof(*result), SEEK_END) == 0
+		&& fread(result, sizeof(*result), 1, job->output) == 1
+		&& result->magic == CUTL_JOB_MAGIC
+	) {
+		size -= sizeof(*result);
+	}
+	return size;
+}
+
+
+// Parts sent back by workers are their output, then each of their reports,
+// then the functions their test covered.
+static void cutl_job_replay_part(
+	Cutl_Job *job, int part, const char *data, size_t len)
+{
+	if (part == 0) {
+		cutl_write(&job->cutl, data, len);
+	} else if (part <= CUTL_NB_REPORTS) {
+		cutl_report_write(&job->cutl, part - 1, data, len);
+	} else if (len > 0) {
+		cutl_append(&job->coverage, data, len);
+	}
+}
+
+
+// The output is followed by `report_sizes` bytes of each report, then by
+// `coverage_size` bytes of addresses.
+static void cutl_job_replay(
+	Cutl_Job *job, long size, const Cutl_Job_Result *result)
+{
+	size_t parts[2 + CUTL_NB_REPORTS] = {size};
+	size_t left = size;
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		parts[i + 1] = result->report_sizes[i];
+		left += result->report_sizes[i];
+	}
+	parts[1 + CUTL_NB_REPORTS] = result->coverage_size;
+	left += result->coverage_size;
+
+#ifdef CUTL_USE_MMAP
+	if (job->slot != NULL) {
+		const char *data = job->slot->output;
+		for (int i=0; i<=1 + CUTL_NB_REPORTS; ++i) {
+			cutl_job_replay_part(job, i, data, parts[i]);
+			data += parts[i];
+		}
+		job->slot = NULL;
+		cutl_ring_give(job->cutl.globals, false);
+		return;
+	}
+#endif
+
+	char buffer[BUFSIZ];
+	size_t len;
+	int part = 0;
+	rewind(job->output);
+	while (left > 0 && (len = fread(
+		buffer, 1, left < BUFSIZ ? left : BUFSIZ, job->output)) > 0
+	) {
+		left -= len;
+		for (size_t pos = 0; pos < len; ++part) {
+			const size_t head = parts[part] < len - pos
+				? parts[part] : len - pos;
+			cutl_job_replay_part(job, part, buffer + pos, head);
+			parts[part] -= head;
+			pos += head;
+			if (parts[part] > 0) break;
+		}
+	}
+	fclose(job->output);
+}
+
+
+// Gives back what the worker sent without replaying it.
+static void cutl_job_discard_fork(Cutl_Job *job)
+{
+	cutl_job_wait(job, 0);
+
+#ifdef CUTL_USE_MMAP
+	if (job->slot != NULL) {
+		job->slot = NULL;
+		cutl_ring_give(job->cutl.globals, false);
+		return;
+	}
+#endif
+
+	fclose(job->output);
+}
+
+
+static void cutl_job_finish_fork(Cutl_Job *job)
+{
+	Cutl *cutl = &job->cutl;
+
+	cutl_job_wait(job, 0);
+
+	Cutl_Job_Result result = {0};
+	long size = cutl_job_read(job, &result);
+	size_t report_size = 0;
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		report_size += result.report_sizes[i];
+	}
+	if (result.magic == CUTL_JOB_MAGIC) {
+		size -= report_size + result.coverage_size;
+		cutl->failed = result.failed;
+		cutl->error = result.error;
+		cutl->nb_children = result.nb_children;
+		cutl->nb_passed = result.nb_passed;
+		cutl->nb_failed = result.nb_failed;
+		cutl->duration = result.duration;
+		cutl->cpu_duration = result.cpu_duration;
+		cutl->heap.count = result.heap_count;
+		cutl->heap.bytes = result.heap_bytes;
+		cutl->heap.peak = result.heap_peak;
+		cutl->heap.nb_allocs = result.heap_allocs;
+		cutl->is_prefixed = result.is_prefixed;
+		cutl->is_infixed = result.is_infixed;
+	} else {
+		memset(result.report_sizes, 0, sizeof(result.report_sizes));
+		result.coverage_size = 0;
+		report_size = 0;
+
+		// Any output starts with the test prefix.
+		cutl->is_prefixed = size > 0;
+		cutl->is_infixed = size > 0;
+	}
+
+	cutl_job_attach(job);
+	cutl_job_replay(job, size, &result);
+#ifdef CUTL_INCREMENTAL_ENABLED
+	const uintptr_t *functions = (const void*) job->coverage.data;
+	for (size_t i=0; i<job->coverage.size / sizeof(*functions); ++i) {
+		cutl_coverage_add(&cutl->coverage, functions[i]);
+	}
+#endif
+	free(job->coverage.data);
+
+	// Reports of the worker end with this test.
+	if (report_size > 0) {
+		cutl_report_parent(cutl)->nb_reported++;
+	}
+
+	if (result.magic != CUTL_JOB_MAGIC) {
+		cutl->duration = cutl_time() - cutl->started;
+		cutl_report_start(cutl);
+#ifdef CUTL_TIMEOUT_ENABLED
+		// Tests may have set their own limits, only the worker knows.
+		const int sig = WIFSIGNALED(job->status)
+			? WTERMSIG(job->status) : 0;
+		if (sig == SIGALRM || sig == SIGVTALRM) {
+			cutl_message_at(
+				cutl, CUTL_FAIL, NULL, 0,
+				"Timed out after %.3f s%s.", cutl->duration,
+				sig == SIGVTALRM ? " (CPU)" : ""
+			);
+		} else
+#endif
+		if (WIFSIGNALED(job->status)) {
+			cutl_message_at(
+				cutl, CUTL_FAIL, NULL, 0,
+				"Worker killed by signal %d.",
+				WTERMSIG(job->status)
+			);
+		} else {
+			cutl_message_at(
+				cutl, CUTL_FAIL, NULL, 0,
+				"Worker exited with status %d.",
+				WEXITSTATUS(job->status)
+			);
+		}
+		cutl_prefix(cutl);
+		cutl_suffix(cutl);
+		cutl_report_end(cutl);
+	}
+}
+
+#endif
+
+
+
+// PARALLEL THREADS
+
+#ifdef CUTL_USE_PTHREAD
+
+// Each worker owns a deque of tasks: it runs its own tasks newest first, which
+// keeps nested suites depth-first, and steals the oldest task of another
+// worker when it runs out. Deque 0 belongs to the thread that started the
+// tests, which only runs tasks while it waits for them.
+typedef struct {
+	Cutl_Pool *pool;
+	pthread_t thread;
+	int index;
+	Cutl_Job *top, *bottom;
+} Cutl_Worker;
+
+struct Cutl_Pool {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	Cutl_Worker **workers;
+	int nb_workers;
+	bool is_stopping;
+};
+
+
+static void cutl_pool_push(Cutl_Worker *worker, Cutl_Job *job)
+{
+	job->prev_task = worker->bottom;
+	job->next_task = NULL;
+	if (worker->bottom) {
+		worker->bottom->next_task = job;
+	} else {
+		worker->top = job;
+	}
+	worker->bottom = job;
+}
+
+
+static Cutl_Job *cutl_pool_remove(Cutl_Worker *worker, Cutl_Job *job)
+{
+	if (job->prev_task) {
+		job->prev_task->next_task = job->next_task;
+	} else {
+		worker->top = job->next_task;
+	}
+	if (job->next_task) {
+		job->next_task->prev_task = job->prev_task;
+	} else {
+		worker->bottom = job->prev_task;
+	}
+	job->prev_task = job->next_task = NULL;
+	return job;
+}
+
+
+static Cutl_Job *cutl_pool_pop(Cutl_Pool *pool, int index)
+{
+	Cutl_Worker *self = pool->workers[index];
+	if (self->bottom != NULL) {
+		return cutl_pool_remove(self, self->bottom);
+	}
+
+	for (int i=1; i<pool->nb_workers; ++i) {
+		const int victim_index = (index + i) % pool->nb_workers;
+		Cutl_Worker *victim = pool->workers[victim_index];
+		if (victim->top != NULL) {
+			return cutl_pool_remove(victim, victim->top);
+		}
+	}
+
+	return NULL;
+}
+
+
+// Must be called with the pool lock held, which is released while the test is
+// running.
+static void cutl_pool_execute(Cutl_Pool *pool, Cutl_Job *job, int index)
+{
+	// Tests spawned by this one go to the deque of the worker running it.
+	job->cutl.worker = index;
+
+	pthread_mutex_unlock(&pool->lock);
+	cutl_execute(&job->cutl, &job->task);
+	pthread_mutex_lock(&pool->lock);
+
+	job->is_done = true;
+	pthread_cond_broadcast(&pool->cond);
+}
+
+
+static void *cutl_pool_main(void *data)
+{
+	Cutl_Worker *worker = data;
+	Cutl_Pool *pool = worker->pool;
+
+	pthread_mutex_lock(&pool->lock);
+	while (!pool->is_stopping) {
+		Cutl_Job *job = cutl_pool_pop(pool, worker->index);
+		if (job != NULL) {
+			cutl_pool_execute(pool, job, worker->index);
+		} else {
+			pthread_cond_wait(&pool->cond, &pool->lock);
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	return NULL;
+}
+
+
+static Cutl_Worker *cutl_pool_add(Cutl_Pool *pool)
+{
+	Cutl_Worker *worker = cutl_calloc(1, sizeof(*worker));
+	worker->pool = pool;
+	worker->index = pool->nb_workers;
+
+	pool->workers = realloc(
+		pool->workers, (pool->nb_workers + 1) * sizeof(*pool->workers)
+	);
+	assert(pool->workers != NULL);
+	pool->workers[pool->nb_workers++] = worker;
+
+	return worker;
+}
+
+
+static Cutl_Pool *cutl_pool_get(Cutl_Globals *globals, int nb_threads)
+{
+	Cutl_Pool *pool = globals->pool;
+	if (pool == NULL) {
+		pool = cutl_calloc(1, sizeof(*pool));
+		pthread_mutex_init(&pool->lock, NULL);
+		pthread_cond_init(&pool->cond, NULL);
+		cutl_pool_add(pool);
+		globals->pool = pool;
+	}
+
+	// The pool only grows, up to the largest number of threads requested.
+	pthread_mutex_lock(&pool->lock);
+	while (pool->nb_workers <= nb_threads) {
+		Cutl_Worker *worker = cutl_pool_add(pool);
+		pthread_t *thread = &worker->thread;
+		if (pthread_create(thread, NULL, cutl_pool_main, worker)) {
+			pool->nb_workers--;
+			free(worker);
+			break;
+		}
+	}
+	const bool has_threads = pool->nb_workers > 1;
+	pthread_mutex_unlock(&pool->lock);
+
+	return has_threads ? pool : NULL;
+}
+
+
+static void cutl_pool_free(Cutl_Pool *pool)
+{
+	if (pool == NULL) return;
+
+	pthread_mutex_lock(&pool->lock);
+	pool->is_stopping = true;
+	pthread_cond_broadcast(&pool->cond);
+	pthread_mutex_unlock(&pool->lock);
+
+	for (int i=1; i<pool->nb_workers; ++i) {
+		pthread_join(pool->workers[i]->thread, NULL);
+	}
+
+	pthread_cond_destroy(&pool->cond);
+	pthread_mutex_destroy(&pool->lock);
+	for (int i=0; i<pool->nb_workers; ++i) {
+		free(pool->workers[i]);
+	}
+	free(pool->workers);
+	free(pool);
+}
+
+
+static void cutl_job_close_reports(Cutl_Job *job)
+{
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		if (job->reports[i] != NULL) fclose(job->reports[i]);
+		job->reports[i] = NULL;
+		job->cutl.reports[i] = NULL;
+	}
+	free(job->cutl.strings.ids);
+	job->cutl.strings = (Cutl_Strings) {0};
+}
+
+
+static bool cutl_job_thread(Cutl *parent, Cutl_Job *job)
+{
+	Cutl_Pool *pool = cutl_pool_get(
+		parent->globals, parent->settings.threads
+	);
+	if (pool == NULL) return false;
+
+	job->output = open_memstream(&job->buffer, &job->size);
+	if (job->output == NULL) return false;
+	job->cutl.settings.output = job->output;
+	job->cutl.is_threaded = true;
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		if (cutl_report_file(parent, i) == NULL) continue;
+
+		job->reports[i] = open_memstream(
+			&job->report_buffers[i], &job->report_sizes[i]
+		);
+		if (job->reports[i] == NULL) {
+			cutl_job_close_reports(job);
+			for (int j=0; j<i; ++j) free(job->report_buffers[j]);
+			fclose(job->output);
+			free(job->buffer);
+			return false;
+		}
+		job->cutl.reports[i] = job->reports[i];
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	cutl_pool_push(pool->workers[parent->worker], job);
+	pthread_cond_signal(&pool->cond);
+	pthread_mutex_unlock(&pool->lock);
+
+	return true;
+}
+
+
+static void cutl_job_wait_thread(Cutl_Job *job)
+{
+	Cutl_Pool *pool = job->cutl.globals->pool;
+	const int index = job->cutl.parent->worker;
+
+	// Help running pending tests rather than just waiting.
+	pthread_mutex_lock(&pool->lock);
+	while (!job->is_done) {
+		Cutl_Job *task = cutl_pool_pop(pool, index);
+		if (task != NULL) {
+			cutl_pool_execute(pool, task, index);
+		} else {
+			pthread_cond_wait(&pool->cond, &pool->lock);
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+}
+
+
+// Frees what the test wrote without replaying it.
+static void cutl_job_discard_thread(Cutl_Job *job)
+{
+	cutl_job_wait_thread(job);
+
+	fclose(job->output);
+	free(job->buffer);
+	cutl_job_close_reports(job);
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		free(job->report_buffers[i]);
+	}
+#ifdef CUTL_INCREMENTAL_ENABLED
+	free(job->cutl.coverage.functions);
+#endif
+}
+
+
+static void cutl_job_finish_thread(Cutl_Job *job)
+{
+	cutl_job_wait_thread(job);
+
+	Cutl *cutl = &job->cutl;
+	fclose(job->output);
+	cutl->settings.output = cutl->parent->settings.output;
+
+	cutl_job_attach(job);
+	cutl_write(cutl->parent, job->buffer, job->size);
+	free(job->buffer);
+
+	cutl_job_close_reports(job);
+	bool is_reported = false;
+	for (int i=0; i<CUTL_NB_REPORTS; ++i) {
+		const size_t size = job->report_sizes[i];
+		cutl_report_write(cutl, i, job->report_buffers[i], size);
+		free(job->report_buffers[i]);
+		is_reported = is_reported || size > 0;
+	}
+	if (is_reported) {
+		cutl_report_parent(cutl)->nb_reported++;
+	}
+}
+
+#endif
+
+
+static void cutl_join_first(Cutl *parent)
+{
+	Cutl_Job *job = parent->first_job;
+	parent->first_job = job->next;
+	if (parent->first_job == NULL) {
+		parent->last_job = NULL;
+	}
+
+	// Earlier errors cancel the rest of the test sequence, output included.
+	if (parent->error) {
+#ifdef CUTL_USE_FORK
+		if (job->is_forked) cutl_job_discard_fork(job);
+#endif
+#ifdef CUTL_USE_PTHREAD
+		if (!job->is_forked) cutl_job_discard_thread(job);
+#endif
+	} else {
+#ifdef CUTL_USE_FORK
+		if (job->is_forked) cutl_job_finish_fork(job);
+#endif
+#ifdef CUTL_USE_PTHREAD
+		if (!job->is_forked) cutl_job_finish_thread(job);
+#endif
+		cutl_merge(parent, &job->cutl);
+	}
+
+	free(job->cutl.line.data);
+	free(job);
 }
 
 
-static void cutl_vmessage_at(
-	Cutl *cutl, int type, const char *file, int line, const char *fmt,
-	va_list ap)
+static void cutl_join(Cutl *parent)
 {
-	assert(cutl != NULL);
-	assert(fmt != NULL);
+	// Timeouts must not interrupt the test while it waits for others.
+	const int stage = parent->stage;
+	parent->stage = 0;
 
-	if (type & CUTL_ERROR) {
-		cutl->error = true;
-		cutl->failed = true;
-	} if (type & CUTL_FAIL) {
-		cutl->failed = true;
+	while (parent->first_job != NULL) {
+		cutl_join_first(parent);
 	}
 
-	if (!CUTL_VERBCHECK(cutl, type)) return;
+	parent->stage = stage;
+}
 
 
-	cutl_prefix(cutl);
-	cutl_infix(cutl, ":");
-	cutl_indent(cutl);
-	if (cutl->depth > 0) {
-		// Extra indentation if test has a parent.
-		fprintf(cutl->settings.output, "%s", cutl->settings.indent);
+#ifdef CUTL_USE_FORK
+// Joins the workers already done at the head of the sequence, which gives
+// their shared memory back early.
+static void cutl_join_done(Cutl *parent)
+{
+	while (parent->first_job != NULL && parent->first_job->is_forked
+		&& parent->first_job->is_done
+	) {
+		cutl_join_first(parent);
 	}
+}
+#endif
 
-	const char *kind = NULL;
-	if (type & CUTL_ERROR) {
-		kind = cutl->has_color
-			? "\033"CUTL_FAIL_COLOR"ERROR\033[0m" : "ERROR";
-	} else if (type & CUTL_FAIL) {
-		kind = cutl->has_color
-			? "\033"CUTL_FAIL_COLOR"FAIL\033[0m" : "FAIL";
-	} else if (type & CUTL_WARN) {
-		kind = "WARN";
-	} else if (type & CUTL_INFO) {
-		kind = "INFO";
+
+static bool cutl_spawn(Cutl *parent, const Cutl *child, const Cutl_Task *task)
+{
+	const Cutl_Globals *globals = parent->globals;
+	if (globals->is_worker && !globals->is_server) return false;
+
+	// Workers are forked for tests only, while threads also take suites so
+	// idle ones can steal from unbalanced nested suites. Servers are forked
+	// to then fork each of their tests, but threads can't be forked safely.
+	const bool use_fork = !parent->is_threaded && (
+		parent->settings.jobs > 1 || parent->settings.is_isolated
+		|| child->is_server || globals->is_server
+	);
+	const bool use_thread = parent->settings.threads > 1;
+	if (use_fork && child->is_suite && !child->is_server) return false;
+	if (!use_fork && !use_thread) return false;
+
+	// Benchmarks are measured once the tests spawned before them are done.
+	if (task->is_bench) return false;
+
+	Cutl_Job *job = cutl_calloc(1, sizeof(*job));
+	memcpy(&job->cutl, child, sizeof(*child));
+	job->cutl.is_detached = true;
+	job->task = *task;
+
+	bool is_spawned = false;
+#ifdef CUTL_USE_FORK
+	if (use_fork) {
+		is_spawned = cutl_job_fork(parent, job);
 	}
+#endif
+#ifdef CUTL_USE_PTHREAD
+	if (!use_fork && use_thread) {
+		is_spawned = cutl_job_thread(parent, job);
+	}
+#endif
 
-	if (kind) {
-		if (file) {
-			fprintf(
-				cutl->settings.output, "[%s %s:%d] ", kind,
-				file, line
-			);
-		} else {
-			fprintf(cutl->settings.output, "[%s] ", kind);
-		}
+	if (!is_spawned) {
+		free(job);
+		return false;
 	}
 
-	vfprintf(cutl->settings.output, fmt, ap);
+	if (parent->last_job) {
+		parent->last_job->next = job;
+	} else {
+		parent->first_job = job;
+	}
+	parent->last_job = job;
 
-	fprintf(cutl->settings.output, "\n");
+	return true;
 }
 
-void cutl_message_at(
-	Cutl *cutl, int type, const char *file, int line, const char *fmt, ...)
-{
-	assert(cutl != NULL);
-	assert(fmt != NULL);
 
-	va_list ap;
-	va_start(ap, fmt);
-	cutl_vmessage_at(cutl, type, file, line, fmt, ap);
-	va_end(ap);
+static int cutl_next_id(Cutl_Globals *globals)
+{
+#ifdef CUTL_USE_PTHREAD
+	return __atomic_add_fetch(&globals->last_id, 1, __ATOMIC_RELAXED);
+#else
+	return ++globals->last_id;
+#endif
 }
 
 
-
-// TESTING
-
-void cutl_at_start(Cutl *cutl, Cutl_Func *func, void *data)
+// FNV-1a hash of the names, with a separator so that "ab/c" and "a/bc" differ.
+static uint32_t cutl_hash(uint32_t hash, const char *name)
 {
-	assert(cutl != NULL);
-
-	cutl->start = func;
-	cutl->start_data = data;
+	hash = (hash ^ '/') * CUTL_HASH_PRIME;
+	for (const char *c = name; *c != '\0'; ++c) {
+		hash = (hash ^ (unsigned char) *c) * CUTL_HASH_PRIME;
+	}
+	return hash;
 }
 
 
-void cutl_at_end(Cutl *cutl, Cutl_Func *func, void *data)
+static bool cutl_in_unit(const Cutl *cutl)
 {
-	assert(cutl != NULL);
-
-	cutl->end = func;
-	cutl->end_data = data;
+	for (; cutl != NULL; cutl = cutl->parent) {
+		if (cutl->is_unit) return true;
+	}
+	return false;
 }
 
 
-void cutl_at_interrupt(Cutl *cutl, Cutl_Func *func, void *data)
+static int cutl_start(
+	Cutl *parent, const char *name, Cutl_Func *test, void *data,
+	Cutl_Kind kind)
 {
-	assert(cutl != NULL);
+	if (parent->error || cutl_is_timed_out(parent)) return 1;
 
-	cutl->interrupt = func;
-	cutl->interrupt_data = data;
-}
+	const bool is_suite = kind == CUTL_KIND_SUITE
+		|| kind == CUTL_KIND_SERVER;
 
+	// Tests are filtered before their fixtures are run, suites only once no
+	// test of theirs could match.
+	if (name != NULL && !cutl_filter_check(parent, name, is_suite)) {
+		if (!is_suite) parent->nb_skipped++;
+		return 0;
+	}
 
-int cutl_run(Cutl *parent, const char *name, Cutl_Func *test, void *data)
-{
-	assert(parent != NULL);
-	assert(test != NULL);
+	// Tests are sharded and timed as a whole, suites are run to shard their
+	// children. Skipped tests are not counted at all.
+	const uint32_t key = name ? cutl_hash(parent->key, name) : parent->key;
+	const int shard_count = parent->settings.shard_count;
+	const bool is_unit = name != NULL && !is_suite && !cutl_in_unit(parent);
+	const bool is_sharded = is_unit && shard_count > 1;
+	if (is_sharded) {
+		const int shard_index = cutl_timings_shard(
+			parent->globals, key, shard_count
+		);
+		if (shard_index != parent->settings.shard_index) {
+			parent->nb_skipped++;
+			return 0;
+		}
+	}
 
-	if (parent->error) return 1;
+#ifdef CUTL_INCREMENTAL_ENABLED
+	if (is_unit && parent->globals->is_incremental
+		&& cutl_coverage_unchanged(parent->globals, key)
+	) {
+		parent->nb_skipped++;
+		return 0;
+	}
+#endif
 
 	// Protect variable from compiler optimizations, which *may* cause local
 	// variables to be stored inside registers and thus restored end a
 	// call to longjmp().
 	volatile Cutl child = {
 		.name = name,
-		.id = ++parent->globals->last_id,
+		.id = cutl_next_id(parent->globals),
 		.depth = parent->depth + (name ? 1 : 0),
+		.key = key,
 		.parent = parent,
 		.globals = parent->globals,
 		.settings = parent->settings,
 		.has_color = parent->has_color,
 		.test_data = data,
+		.is_suite = is_suite,
+		.is_unit = is_unit,
+		.is_server = kind == CUTL_KIND_SERVER,
+		.is_threaded = parent->is_threaded,
+		.worker = parent->worker,
 	};
 	Cutl *cutl = (Cutl*) &child;
 
-	// Testing
-	if (parent->start) {
-		if (setjmp(cutl->env) == 0) {
-			parent->start(cutl, parent->start_data);
-		}
-	}
-
-	if (!cutl->failed) {
-		if (setjmp(cutl->env) == 0) {
-			test(cutl, cutl->test_data);
-		}
-		if (parent->end) {
-			if (setjmp(cutl->env) == 0) {
-				parent->end(cutl, parent->end_data);
-			}
-		}
+	// Tests of the shard are run whole.
+	if (is_sharded) {
+		cutl_set_shard(cutl, 0, 0);
 	}
 
-	// Reporting
-	if (cutl->is_prefixed
-		|| (cutl->nb_children == 0 && CUTL_VERBCHECK(cutl, CUTL_TESTS))
-		|| (cutl->nb_children != 0 && CUTL_VERBCHECK(cutl, CUTL_SUITES))
-	) {
-		cutl_prefix(cutl);
-		cutl_suffix(cutl);
-	}
+	// Fixtures are copied, the parent may change them while the test runs.
+	const Cutl_Task task = {
+		.test = test,
+		.start = parent->start, .start_data = parent->start_data,
+		.end = parent->end, .end_data = parent->end_data,
+		.is_bench = kind == CUTL_KIND_BENCH,
+	};
 
-	if (cutl->nb_children == 0 && cutl->name != NULL) {
-		parent->nb_children++;
-		if (cutl->failed) {
-			parent->nb_failed++;
-		} else {
-			parent->nb_passed++;
-		}
-	} else {
-		parent->nb_children += cutl->nb_children;
-		parent->nb_passed += cutl->nb_passed;
-		parent->nb_failed += cutl->nb_failed;
+	if (name != NULL && cutl_spawn(parent, cutl, &task)) {
+		return 0;
 	}
 
-	if (cutl->failed) parent->failed = true;
-	if (cutl->error) {
-		parent->error = true;
-	}
+	// Anything run inline comes after the tests already spawned.
+	cutl_join(parent);
+	if (parent->error) return 1;
 
+	cutl_execute(cutl, &task);
+	cutl_merge(parent, cutl);
 
 	return cutl_get_failed(cutl);
 }
 
 
+static int cutl_run_at(
+	Cutl *parent, const char *name, Cutl_Func *test, void *data,
+	Cutl_Kind kind)
+{
+	assert(parent != NULL);
+	assert(test != NULL);
+
+	// Timeouts must not interrupt the test while it starts another one.
+	const int stage = parent->stage;
+	parent->stage = 0;
+	const int failed = cutl_start(parent, name, test, data, kind);
+	parent->stage = stage;
+
+	return failed;
+}
+
+
+int cutl_run(Cutl *parent, const char *name, Cutl_Func *test, void *data)
+{
+	return cutl_run_at(parent, name, test, data, CUTL_KIND_TEST);
+}
+
+
+int cutl_run_as_suite(
+	Cutl *parent, const char *name, Cutl_Func *test, void *data)
+{
+	return cutl_run_at(parent, name, test, data, CUTL_KIND_SUITE);
+}
+
+
+int cutl_run_as_server(
+	Cutl *parent, const char *name, Cutl_Func *test, void *data)
+{
+	return cutl_run_at(parent, name, test, data, CUTL_KIND_SERVER);
+}
+
+
+int cutl_bench(Cutl *parent, const char *name, Cutl_Func *func, void *data)
+{
+	return cutl_run_at(parent, name, func, data, CUTL_KIND_BENCH);
+}
+
+
 void cutl_interrupt(Cutl *cutl)
 {
 	assert(cutl != NULL);
@@ -649,6 +6055,8 @@ void cutl_interrupt(Cutl *cutl)
 	if (cutl->id > 0) {
 		longjmp(cutl->env, cutl->stage);
 	} else {
+		cutl_join(cutl);
+		cutl_drain(cutl);
 		exit(cutl_get_failed(cutl));
 	}
 }
@@ -683,6 +6091,255 @@ void cutl_error_at(Cutl *cutl, const char *file, int line, const char *fmt, ...)
 
 
 
+// REGISTRY
+
+#ifdef CUTL_USE_SECTIONS
+// Suites by name, then their fixture, then their tests where they are defined.
+static int cutl_entry_cmp(const void *a, const void *b)
+{
+	const Cutl_Entry *entry1 = *(const Cutl_Entry * const *) a;
+	const Cutl_Entry *entry2 = *(const Cutl_Entry * const *) b;
+
+	int cmp = strcmp(entry1->suite, entry2->suite);
+	if (cmp != 0) return cmp;
+	if (entry1->name == NULL || entry2->name == NULL) {
+		return (entry2->name == NULL) - (entry1->name == NULL);
+	}
+	cmp = strcmp(entry1->file, entry2->file);
+	if (cmp != 0) return cmp;
+	if (entry1->line != entry2->line) {
+		return entry1->line < entry2->line ? -1 : 1;
+	}
+	return strcmp(entry1->name, entry2->name);
+}
+
+
+// Whether the sorted entry is the first of its suite.
+static bool cutl_entry_is_first(const Cutl_Entry **entries, size_t i)
+{
+	return i == 0 || strcmp(entries[i]->suite, entries[i - 1]->suite) != 0;
+}
+
+
+// Ranks of tests, in the order they are run by cutl_set_failed_first().
+enum {
+	CUTL_RANK_FIXTURE,
+	CUTL_RANK_FAILED,
+	CUTL_RANK_NEW,
+	CUTL_RANK_PASSED,
+};
+
+typedef struct {
+	size_t index;
+	int rank;
+	double duration;
+} Cutl_Ranked;
+
+
+static int cutl_ranked_cmp(const void *a, const void *b)
+{
+	const Cutl_Ranked *ra = a, *rb = b;
+	if (ra->rank != rb->rank) return ra->rank - rb->rank;
+	if (ra->duration != rb->duration) {
+		return ra->duration < rb->duration ? -1 : 1;
+	}
+	return (ra->index > rb->index) - (ra->index < rb->index);
+}
+
+
+// Ranks the test by its cached result, and stores its cached duration.
+static int cutl_cache_rank(
+	const Cutl_Globals *globals, uint32_t key, double *duration)
+{
+	if (globals->cache.size == 0) return CUTL_RANK_NEW;
+
+	const Cutl_Timing timing = {.key = key};
+	const Cutl_Timing *found = bsearch(
+		&timing, globals->cache.items, globals->cache.size,
+		sizeof(timing), cutl_timing_cmp_key
+	);
+	if (found == NULL) return CUTL_RANK_NEW;
+
+	*duration = found->duration;
+	return found->status == 'F' ? CUTL_RANK_FAILED : CUTL_RANK_PASSED;
+}
+
+
+// Tests that failed last time come first, then new ones, then the others,
+// shortest first. Suites come in the order of their first test, then
+// shortest first.
+static void cutl_registry_order(Cutl_Registry *registry, const Cutl *cutl)
+{
+	const size_t nb_suites = registry->nb_suites;
+	Cutl_Ranked *order = cutl_malloc(nb_suites * sizeof(*order));
+
+	for (size_t i=0; i<nb_suites; ++i) {
+		Cutl_Registered *suite = &registry->suites[i];
+		const uint32_t key = cutl_hash(cutl->key, suite->name);
+		order[i] = (Cutl_Ranked) {.index = i, .rank = CUTL_RANK_PASSED};
+
+		Cutl_Ranked *ranked = cutl_malloc(
+			suite->count * sizeof(*ranked)
+		);
+		for (size_t j=0; j<suite->count; ++j) {
+			const Cutl_Entry *entry = suite->entries[j];
+			ranked[j] = (Cutl_Ranked) {
+				.index = j, .rank = CUTL_RANK_FIXTURE
+			};
+			if (entry->name == NULL) continue;
+
+			ranked[j].rank = cutl_cache_rank(
+				cutl->globals, cutl_hash(key, entry->name),
+				&ranked[j].duration
+			);
+			if (ranked[j].rank < order[i].rank) {
+				order[i].rank = ranked[j].rank;
+			}
+			order[i].duration += ranked[j].duration;
+		}
+		qsort(ranked, suite->count, sizeof(*ranked), cutl_ranked_cmp);
+
+		const size_t size = suite->count * sizeof(*suite->entries);
+		const Cutl_Entry **entries = cutl_malloc(size);
+		for (size_t j=0; j<suite->count; ++j) {
+			entries[j] = suite->entries[ranked[j].index];
+		}
+		memcpy(suite->entries, entries, size);
+		free(entries);
+		free(ranked);
+	}
+	qsort(order, nb_suites, sizeof(*order), cutl_ranked_cmp);
+
+	Cutl_Registered *suites = cutl_malloc(nb_suites * sizeof(*suites));
+	for (size_t i=0; i<nb_suites; ++i) {
+		suites[i] = registry->suites[order[i].index];
+	}
+	free(registry->suites);
+	registry->suites = suites;
+	free(order);
+}
+
+
+// The registry is built when first needed, the same whatever the order the
+// entries were linked in, then ordered by their results if asked to.
+static const Cutl_Registry *cutl_registry_get(const Cutl *cutl)
+{
+	Cutl_Globals *globals = cutl->globals;
+	Cutl_Registry *registry = &globals->registry;
+
+	cutl_lock(globals);
+	if (registry->entries == NULL && __start_cutl_tests != NULL) {
+		const size_t count = __stop_cutl_tests - __start_cutl_tests;
+		const Cutl_Entry **entries = cutl_malloc(
+			count * sizeof(*entries)
+		);
+		memcpy(entries, __start_cutl_tests, count * sizeof(*entries));
+		qsort(entries, count, sizeof(*entries), cutl_entry_cmp);
+
+		size_t nb_suites = 0;
+		for (size_t i=0; i<count; ++i) {
+			if (cutl_entry_is_first(entries, i)) nb_suites++;
+		}
+
+		Cutl_Registered *suites = cutl_calloc(
+			nb_suites, sizeof(*suites)
+		);
+		Cutl_Registered *suite = suites - 1;
+		for (size_t i=0; i<count; ++i) {
+			if (cutl_entry_is_first(entries, i)) {
+				++suite;
+				suite->name = entries[i]->suite;
+				suite->entries = entries + i;
+			}
+			suite->count++;
+		}
+
+		registry->entries = entries;
+		registry->suites = suites;
+		registry->nb_suites = nb_suites;
+		if (globals->is_failed_first) {
+			cutl_registry_order(registry, cutl);
+		}
+	}
+	cutl_unlock(globals);
+
+	return registry;
+}
+
+
+static void cutl_registry_suite(Cutl *cutl, void *data)
+{
+	const Cutl_Registered *suite = data;
+
+	for (size_t i=0; i<suite->count; ++i) {
+		const Cutl_Entry *entry = suite->entries[i];
+		if (entry->name == NULL) {
+			cutl_at_start(cutl, entry->func, NULL);
+			cutl_at_end(cutl, entry->end, NULL);
+		} else {
+			cutl_run(cutl, entry->name, entry->func, NULL);
+		}
+	}
+}
+#endif
+
+
+int cutl_run_registered(Cutl *cutl)
+{
+	assert(cutl != NULL);
+
+	int failed = 0;
+#ifdef CUTL_USE_SECTIONS
+	const Cutl_Registry *registry = cutl_registry_get(cutl);
+	for (size_t i=0; i<registry->nb_suites; ++i) {
+		Cutl_Registered *suite = &registry->suites[i];
+		failed += cutl_run_as_suite(
+			cutl, suite->name, cutl_registry_suite, suite
+		);
+	}
+#endif
+	return failed;
+}
+
+
+// Lists the tests that cutl_run_registered() would run, filtered and sharded
+// the same way.
+static void cutl_registry_list(Cutl *cutl)
+{
+#ifdef CUTL_USE_SECTIONS
+	const Cutl_Registry *registry = cutl_registry_get(cutl);
+	const int shard_count = cutl->settings.shard_count;
+	const bool is_sharded = shard_count > 1 && !cutl_in_unit(cutl);
+
+	for (size_t i=0; i<registry->nb_suites; ++i) {
+		const Cutl_Registered *suite = &registry->suites[i];
+		if (!cutl_filter_check(cutl, suite->name, true)) continue;
+		const uint32_t key = cutl_hash(cutl->key, suite->name);
+
+		for (size_t j=0; j<suite->count; ++j) {
+			const Cutl_Entry *entry = suite->entries[j];
+			if (entry->name == NULL) continue;
+
+			char *path = cutl_malloc(
+				strlen(suite->name) + strlen(entry->name) + 2
+			);
+			sprintf(path, "%s/%s", suite->name, entry->name);
+			const bool is_listed = cutl_filter_check(
+				cutl, path, false
+			) && (!is_sharded || cutl_timings_shard(
+				cutl->globals, cutl_hash(key, entry->name),
+				shard_count
+			) == cutl->settings.shard_index);
+
+			if (is_listed) printf("%s\n", path);
+			free(path);
+		}
+	}
+#endif
+}
+
+
+
 // ASSERT
 
 void cutl_assert_at(
@@ -726,8 +6383,15 @@ int cutl_summary(Cutl *cutl)
 {
 	assert(cutl != NULL);
 
+	cutl_join(cutl);
+	cutl_timings_write(cutl);
+	cutl_report_end(cutl_get_root(cutl));
+
 	const int nb_failed = cutl_get_failed(cutl);
-	if (!CUTL_VERBCHECK(cutl, CUTL_SUMMARY)) return nb_failed;
+	if (!CUTL_VERBCHECK(cutl, CUTL_SUMMARY)) {
+		cutl_drain(cutl);
+		return nb_failed;
+	}
 
 	const char *start_color = "", *stop_color = "";
 	if (cutl->has_color) {
@@ -739,20 +6403,47 @@ int cutl_summary(Cutl *cutl)
 
 	cutl_indent(cutl);
 
+	cutl_printf(cutl, "%s%s", start_color, cutl->name);
+	if (cutl->settings.shard_count > 1) {
+		cutl_printf(
+			cutl, " (shard %d/%d)", cutl->settings.shard_index,
+			cutl->settings.shard_count
+		);
+	}
+
 	if (cutl->error) {
-		fprintf(
-			cutl->settings.output,
-			"%s%s summary: canceled.%s\n", start_color, cutl->name,
-			stop_color);
+		cutl_printf(cutl, " summary: canceled.%s\n", stop_color);
 	} else {
-		fprintf(
-			cutl->settings.output,
-			"%s%s summary: %d failed, %d passed.%s\n",
-			start_color,
-			cutl->name, nb_failed, cutl->nb_passed,
-			stop_color
+		cutl_printf(
+			cutl, " summary: %d failed, %d passed.%s\n",
+			nb_failed, cutl->nb_passed, stop_color
+		);
+	}
+
+	Cutl_Globals *globals = cutl->globals;
+	cutl_lock(globals);
+	if (globals->slowest.size > 0) {
+		cutl_indent(cutl);
+		cutl_puts(cutl, "Slowest tests:\n");
+	}
+	for (size_t i=0; i<globals->slowest.size; ++i) {
+		const Cutl_Timing *timing = &globals->slowest.items[i];
+		cutl_indent(cutl);
+		cutl_printf(
+			cutl, "%s%.3f ms %s\n", cutl->settings.indent,
+			timing->duration * 1e3, timing->name
+		);
+	}
+	if (globals->heap_peak_name != NULL) {
+		cutl_indent(cutl);
+		cutl_printf(
+			cutl, "Largest heap peak: %zu bytes in %s.\n",
+			globals->heap_peak, globals->heap_peak_name
 		);
 	}
+	cutl_unlock(globals);
+	cutl_flush(cutl);
+	cutl_drain(cutl);
 
 	return nb_failed;
 }
@@ -813,6 +6504,8 @@ int cutl_get_children(Cutl *cutl)
 {
 	assert(cutl != NULL);
 
+	cutl_join(cutl);
+
 	return cutl->nb_children;
 }
 
@@ -821,6 +6514,8 @@ int cutl_get_passed(Cutl *cutl)
 {
 	assert(cutl != NULL);
 
+	cutl_join(cutl);
+
 	return cutl->nb_passed;
 }
 
@@ -829,6 +6524,8 @@ int cutl_get_failed(Cutl *cutl)
 {
 	assert(cutl != NULL);
 
+	cutl_join(cutl);
+
 	if (cutl->failed && cutl->nb_failed > 0) {
 		return cutl->nb_failed;
 	}
@@ -840,6 +6537,8 @@ bool cutl_get_error(Cutl *cutl)
 {
 	assert(cutl != NULL);
 
+	cutl_join(cutl);
+
 	return cutl->error;
 }
 
@@ -0,0 +1,446 @@
+/* CUTL-DECODE - Turns binary logs of cutl into text, JSON or a summary.
+ * AUTHOR: Baptiste "Saend" CEILLIER
+ */
+#include <cutl.h>
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+
+
+// INTERNAL STRUCTS
+
+// Strings of the log by id, as an open addressing table.
+typedef struct {
+	uint64_t *ids;
+	char **strings;
+	size_t count, capacity;
+} Strings;
+
+typedef enum {
+	FORMAT_TEXT,
+	FORMAT_JSON,
+	FORMAT_SUMMARY,
+} Format;
+
+typedef struct {
+	int tests, passed, failed, canceled, suites, messages;
+	double slowest;
+	uint64_t slowest_name;
+	Cutl_Log_Record last;
+} Summary;
+
+
+
+// STRINGS
+
+static const char *strings_get(const Strings *strings, uint64_t id)
+{
+	if (id == 0 || strings->capacity == 0) return "";
+
+	const size_t mask = strings->capacity - 1;
+	for (size_t i = id & mask; strings->ids[i] != 0; i = (i + 1) & mask) {
+		if (strings->ids[i] == id) return strings->strings[i];
+	}
+	return "?";
+}
+
+
+static bool strings_grow(Strings *strings)
+{
+	const size_t capacity = strings->capacity > 0
+		? 2 * strings->capacity : 256;
+	uint64_t *ids = calloc(capacity, sizeof(*ids));
+	char **values = calloc(capacity, sizeof(*values));
+	if (ids == NULL || values == NULL) {
+		free(ids);
+		free(values);
+		return false;
+	}
+
+	for (size_t i=0; i<strings->capacity; ++i) {
+		if (strings->ids[i] == 0) continue;
+
+		size_t j = strings->ids[i] & (capacity - 1);
+		while (ids[j] != 0) j = (j + 1) & (capacity - 1);
+		ids[j] = strings->ids[i];
+		values[j] = strings->strings[i];
+	}
+	free(strings->ids);
+	free(strings->strings);
+	strings->ids = ids;
+	strings->strings = values;
+	strings->capacity = capacity;
+	return true;
+}
+
+
+// Takes ownership of the string. Strings written again replace the previous
+// ones, they are the same.
+static bool strings_put(Strings *strings, uint64_t id, char *str)
+{
+	if (2 * (strings->count + 1) > strings->capacity
+		&& !strings_grow(strings)
+	) {
+		return false;
+	}
+
+	const size_t mask = strings->capacity - 1;
+	size_t i = id & mask;
+	for (; strings->ids[i] != 0; i = (i + 1) & mask) {
+		if (strings->ids[i] == id) break;
+	}
+	if (strings->ids[i] == 0) strings->count++;
+	free(strings->strings[i]);
+	strings->ids[i] = id;
+	strings->strings[i] = str;
+	return true;
+}
+
+
+static void strings_free(Strings *strings)
+{
+	for (size_t i=0; i<strings->capacity; ++i) {
+		free(strings->strings[i]);
+	}
+	free(strings->ids);
+	free(strings->strings);
+}
+
+
+
+// WRITING
+
+static const char *status_name(int status)
+{
+	return status == CUTL_LOG_CANCELED ? "canceled"
+		: status == CUTL_LOG_FAILED ? "failed" : "passed";
+}
+
+
+static const char *severity_name(int type)
+{
+	return (type & CUTL_ERROR) ? "ERROR" : (type & CUTL_FAIL) ? "FAIL"
+		: (type & CUTL_WARN) ? "WARN" : "INFO";
+}
+
+
+static void json_string(FILE *output, const char *str)
+{
+	fputc('"', output);
+	for (const char *c = str; *c != '\0'; ++c) {
+		switch (*c) {
+		case '"': fputs("\\\"", output); break;
+		case '\\': fputs("\\\\", output); break;
+		case '\n': fputs("\\n", output); break;
+		case '\t': fputs("\\t", output); break;
+		default:
+			if ((unsigned char) *c < 0x20) {
+				fprintf(output, "\\u%04x", (unsigned char) *c);
+			} else {
+				fputc(*c, output);
+			}
+		}
+	}
+	fputc('"', output);
+}
+
+
+// Tests are indented by depth, times are from the start of the log.
+static void write_text(
+	FILE *output, const Strings *strings, const Cutl_Log_Record *record,
+	double begin)
+{
+	const char *name = strings_get(strings, record->name);
+	const int indent = record->depth > 0 ? 2 * (record->depth - 1) : 0;
+	fprintf(output, "%12.6f ", record->time - begin);
+
+	switch (record->type) {
+	case CUTL_LOG_START:
+		fprintf(output, "%*s%s:\n", indent, "", name);
+		break;
+	case CUTL_LOG_MESSAGE:
+		fprintf(
+			output, "%*s  [%s", indent, "",
+			severity_name(record->status)
+		);
+		if (record->file != 0) {
+			fprintf(
+				output, " %s:%d",
+				strings_get(strings, record->file), record->line
+			);
+		}
+		fprintf(output, "] %s\n", name);
+		break;
+	case CUTL_LOG_END:
+		fprintf(
+			output, "%*s%s %s (%.3f ms).\n", indent, "", name,
+			status_name(record->status), record->duration * 1e3
+		);
+		break;
+	case CUTL_LOG_SUMMARY:
+		fprintf(
+			output, "summary: %s, %d failed, %d passed, %d "
+			"skipped.\n", status_name(record->status),
+			record->failed, record->passed, record->skipped
+		);
+		break;
+	}
+}
+
+
+// Events are the same as those of JSON reports, with the name of the test in
+// place of its path.
+static void write_json(
+	FILE *output, const Strings *strings, const Cutl_Log_Record *record,
+	double begin)
+{
+	static const char *events[] = {
+		[CUTL_LOG_START] = "test_start",
+		[CUTL_LOG_MESSAGE] = "message",
+		[CUTL_LOG_END] = "test_end",
+		[CUTL_LOG_SUMMARY] = "summary",
+	};
+	fprintf(
+		output, "{\"event\":\"%s\",\"id\":%d,", events[record->type],
+		record->id
+	);
+	if (record->parent >= 0) {
+		fprintf(output, "\"parent\":%d,", record->parent);
+	} else {
+		fputs("\"parent\":null,", output);
+	}
+	fprintf(
+		output, "\"depth\":%d,\"time\":%.6f", record->depth,
+		record->time - begin
+	);
+
+	switch (record->type) {
+	case CUTL_LOG_START:
+		fputs(",\"name\":", output);
+		json_string(output, strings_get(strings, record->name));
+		break;
+	case CUTL_LOG_MESSAGE:
+		fputs(",\"severity\":\"", output);
+		for (const char *c = severity_name(record->status); *c; ++c) {
+			fputc(*c - 'A' + 'a', output);
+		}
+		fputs("\",\"file\":", output);
+		if (record->file != 0) {
+			json_string(output, strings_get(strings, record->file));
+			fprintf(output, ",\"line\":%d", record->line);
+		} else {
+			fputs("null,\"line\":null", output);
+		}
+		fputs(",\"text\":", output);
+		json_string(output, strings_get(strings, record->name));
+		break;
+	case CUTL_LOG_END:
+		fputs(",\"name\":", output);
+		json_string(output, strings_get(strings, record->name));
+		fprintf(
+			output, ",\"suite\":%s,\"duration\":%.6f,"
+			"\"cpu_duration\":%.6f", record->size ? "true"
+			: "false", record->duration, record->cpu_duration
+		);
+		break;
+	}
+
+	const bool is_end = record->type == CUTL_LOG_END
+		|| record->type == CUTL_LOG_SUMMARY;
+	if (is_end) {
+		const char *status = status_name(record->status);
+		fprintf(output, ",\"status\":\"%s\"", status);
+	}
+	if (record->type == CUTL_LOG_SUMMARY || record->size) {
+		fprintf(
+			output, ",\"passed\":%d,\"failed\":%d,\"skipped\":%d",
+			record->passed, record->failed, record->skipped
+		);
+	}
+	fputs("}\n", output);
+}
+
+
+static void add_summary(Summary *summary, const Cutl_Log_Record *record)
+{
+	switch (record->type) {
+	case CUTL_LOG_MESSAGE:
+		summary->messages++;
+		break;
+	case CUTL_LOG_END:
+		if (record->size) {
+			summary->suites++;
+			break;
+		}
+		summary->tests++;
+		summary->passed += record->status == CUTL_LOG_PASSED;
+		summary->failed += record->status == CUTL_LOG_FAILED;
+		summary->canceled += record->status == CUTL_LOG_CANCELED;
+		if (record->duration >= summary->slowest) {
+			summary->slowest = record->duration;
+			summary->slowest_name = record->name;
+		}
+		break;
+	case CUTL_LOG_SUMMARY:
+		summary->last = *record;
+		break;
+	}
+}
+
+
+static void write_summary(
+	FILE *output, const Strings *strings, const Summary *summary,
+	double begin)
+{
+	fprintf(
+		output, "Tests: %d (%d passed, %d failed, %d canceled)\n",
+		summary->tests, summary->passed, summary->failed,
+		summary->canceled
+	);
+	fprintf(output, "Suites: %d\n", summary->suites);
+	fprintf(output, "Messages: %d\n", summary->messages);
+	if (summary->tests > 0) {
+		fprintf(
+			output, "Slowest: %s (%.3f ms)\n",
+			strings_get(strings, summary->slowest_name),
+			summary->slowest * 1e3
+		);
+	}
+
+	const Cutl_Log_Record *last = &summary->last;
+	if (last->type != CUTL_LOG_SUMMARY) {
+		fputs("Incomplete log, no summary.\n", output);
+		return;
+	}
+	fprintf(
+		output, "Summary: %s, %d failed, %d passed, %d skipped in "
+		"%.3f s.\n", status_name(last->status), last->failed,
+		last->passed, last->skipped, last->time - begin
+	);
+}
+
+
+
+// DECODING
+
+// Returns EXIT_SUCCESS once the whole log is decoded.
+static int decode(FILE *input, FILE *output, Format format)
+{
+	Cutl_Log_Record record;
+	if (fread(&record, sizeof(record), 1, input) != 1
+		|| record.type != CUTL_LOG_BEGIN
+		|| record.name != CUTL_LOG_MAGIC
+		|| record.size != sizeof(record)
+	) {
+		fputs("cutl-decode: Not a binary log of cutl.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	const double begin = record.time;
+	Strings strings = {0};
+	Summary summary = {0};
+	int status = EXIT_SUCCESS;
+	while (fread(&record, sizeof(record), 1, input) == 1) {
+		if (record.type == CUTL_LOG_STRING) {
+			const size_t size = record.size;
+			char *str = malloc(size + 1);
+			if (str != NULL && fread(str, 1, size, input) == size) {
+				str[size] = '\0';
+				if (strings_put(&strings, record.name, str)) {
+					continue;
+				}
+			}
+			free(str);
+			status = EXIT_FAILURE;
+			break;
+		}
+
+		if (record.type < CUTL_LOG_START
+			|| record.type > CUTL_LOG_SUMMARY
+		) {
+			status = EXIT_FAILURE;
+			break;
+		}
+
+		switch (format) {
+		case FORMAT_TEXT:
+			write_text(output, &strings, &record, begin);
+			break;
+		case FORMAT_JSON:
+			write_json(output, &strings, &record, begin);
+			break;
+		case FORMAT_SUMMARY:
+			add_summary(&summary, &record);
+			break;
+		}
+	}
+
+	if (status == EXIT_SUCCESS && ferror(input)) status = EXIT_FAILURE;
+	if (status != EXIT_SUCCESS) {
+		fputs("cutl-decode: Corrupted log.\n", stderr);
+	}
+	if (format == FORMAT_SUMMARY) {
+		write_summary(output, &strings, &summary, begin);
+	}
+	strings_free(&strings);
+	return status;
+}
+
+
+static void usage(FILE *output)
+{
+	fputs(
+		"Usage: cutl-decode [-f text|json|summary] [file]\n"
+		"Decodes a binary log of cutl, or the standard input.\n",
+		output
+	);
+}
+
+
+int main(int argc, char *argv[])
+{
+	Format format = FORMAT_TEXT;
+	const char *path = NULL;
+	for (int i=1; i<argc; ++i) {
+		if (strcmp(argv[i], "-h") == 0) {
+			usage(stdout);
+			return EXIT_SUCCESS;
+		} else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			const char *name = argv[++i];
+			if (strcmp(name, "text") == 0) {
+				format = FORMAT_TEXT;
+			} else if (strcmp(name, "json") == 0) {
+				format = FORMAT_JSON;
+			} else if (strcmp(name, "summary") == 0) {
+				format = FORMAT_SUMMARY;
+			} else {
+				usage(stderr);
+				return EXIT_FAILURE;
+			}
+		} else if (path == NULL && argv[i][0] != '-') {
+			path = argv[i];
+		} else {
+			usage(stderr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	FILE *input = stdin;
+	if (path != NULL) {
+		input = fopen(path, "rb");
+		if (input == NULL) {
+			fprintf(
+				stderr, "cutl-decode: Could not open '%s' "
+				"(%s).\n", path, strerror(errno)
+			);
+			return EXIT_FAILURE;
+		}
+	}
+
+	const int status = decode(input, stdout, format);
+	if (input != stdin) fclose(input);
+	return status;
+}
@@ -1056,6 +1056,7 @@ static const Lutl_Constant constants_array[] = {
 	{"SUMMARY", LUTL_CONSTANT_INT, .val.integer = CUTL_SUMMARY},
 	{"TESTS", LUTL_CONSTANT_INT, .val.integer = CUTL_TESTS},
 	{"SUITES", LUTL_CONSTANT_INT, .val.integer = CUTL_SUITES},
+	{"TIMES", LUTL_CONSTANT_INT, .val.integer = CUTL_TIMES},
 	{"SILENT", LUTL_CONSTANT_INT, .val.integer = CUTL_SILENT},
 	{"MINIMAL", LUTL_CONSTANT_INT, .val.integer = CUTL_MINIMAL},
 	{"NORMAL", LUTL_CONSTANT_INT, .val.integer = CUTL_NORMAL},
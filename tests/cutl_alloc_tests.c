@@ -0,0 +1,130 @@
+#include "tests.h"
+
+#include <stdint.h>
+#include <string.h>
+
+
+
+// MY TEST FUNCTIONS
+
+typedef struct {
+	char *small, *large, *after;
+	const char *copy;
+} My_blocks;
+
+static void My_alloc_test(Cutl *cutl, void *data)
+{
+	My_blocks *blocks = data;
+	blocks->small = cutl_alloc(cutl, 3);
+	blocks->large = cutl_alloc(cutl, 100000);
+	blocks->after = cutl_alloc(cutl, sizeof(double));
+	blocks->copy = cutl_strdup(cutl, "copy");
+}
+
+static void My_interrupt_test(Cutl *cutl, void *data)
+{
+	cutl_alloc(cutl, 100);
+	cutl_strdup(cutl, "lost");
+	cutl_interrupt(cutl);
+}
+
+static void My_read_test(Cutl *cutl, void *data)
+{
+	const char *copy = data;
+	cutl_assert_true(cutl, strcmp(copy, "shared") == 0);
+}
+
+static void My_shared_suite(Cutl *cutl, void *data)
+{
+	char *copy = cutl_strdup(cutl, "shared");
+	cutl_run(cutl, "first", My_read_test, copy);
+	cutl_run(cutl, "second", My_read_test, copy);
+}
+
+
+
+/** Blocks are zeroed, aligned and distinct.
+ */
+static void alloc_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	My_blocks blocks = {0};
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_alloc_test, &blocks);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+	cutl_assert(cutl, blocks.small != NULL, "No small block.");
+	cutl_assert(cutl, blocks.large != NULL, "No large block.");
+	cutl_assert(cutl, blocks.after != NULL, "No block after.");
+	cutl_assert(cutl, blocks.copy != NULL, "No copy.");
+	cutl_assert(
+		cutl, blocks.after != blocks.small && blocks.after
+		!= blocks.large, "Blocks overlap."
+	);
+	cutl_assert(
+		cutl, (uintptr_t) blocks.after % sizeof(double) == 0,
+		"Block not aligned."
+	);
+}
+
+
+/** Blocks can be used until the test returns.
+ */
+static void content_test(Cutl *cutl, Fixture *fix)
+{
+	// Function under test
+	char *block = cutl_alloc(fix->cutl, 64);
+	char *copy = cutl_strdup(fix->cutl, "copy");
+
+	// Asserts
+	for (int i=0; i<64; ++i) {
+		cutl_assert_equal(cutl, block[i], 0);
+	}
+	cutl_assert_true(cutl, strcmp(copy, "copy") == 0);
+	cutl_assert(cutl, copy != block, "Same block.");
+}
+
+
+/** Blocks are released even when the test is interrupted.
+ */
+static void interrupt_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_interrupt_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+}
+
+
+/** Blocks of suites are shared with their tests.
+ */
+static void suite_test(Cutl *cutl, Fixture *fix)
+{
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_shared_suite, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 2);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 0);
+}
+
+
+
+// ALLOC SUITE
+
+void cutl_alloc_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, alloc_test);
+	cutl_test(cutl, content_test);
+	cutl_test(cutl, interrupt_test);
+	cutl_test(cutl, suite_test);
+}
@@ -0,0 +1,224 @@
+#include "tests.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+
+// MY TEST FUNCTIONS
+
+enum { NB_LINES = 2000 };
+
+static void My_pass_test(Cutl *cutl, void *data)
+{
+	cutl_assert_true(cutl, true);
+}
+
+static void My_fail_test(Cutl *cutl, void *data)
+{
+	cutl_message_at(cutl, CUTL_INFO, NULL, 0, "My message");
+	cutl_fail_at(cutl, NULL, 0, "My failure");
+}
+
+static void My_suite(Cutl *cutl, void *data)
+{
+	cutl_run(cutl, "test1", My_pass_test, NULL);
+	cutl_run(cutl, "test2", My_fail_test, NULL);
+	cutl_run(cutl, "test3", My_pass_test, NULL);
+}
+
+// More lines than the queue holds at once.
+static void My_long_test(Cutl *cutl, void *data)
+{
+	for (int i=0; i<NB_LINES; ++i) {
+		cutl_message_at(
+			cutl, CUTL_INFO, NULL, 0, "Line %04d of the output.", i
+		);
+	}
+}
+
+
+// Runs the suite verbosely in a separate tree of tests, returns its output.
+static char *My_output(Cutl *cutl, bool is_async)
+{
+	FILE *output = tmpfile();
+	cutl_check(cutl, output != NULL, "Could not make tmp file.");
+	Cutl *other = cutl_new(NULL);
+	cutl_check(cutl, other != NULL, "Could not create test context.");
+	cutl_set_output(other, output);
+	cutl_set_verbosity(other, CUTL_VERBOSE & ~CUTL_TIMES);
+	cutl_set_async(other, is_async);
+	cutl_run(other, "suite", My_suite, NULL);
+	cutl_summary(other);
+	cutl_free(other);
+
+	const long size = ftell(output);
+	char *content = cutl_alloc(cutl, size + 1);
+	rewind(output);
+	content[fread(content, 1, size, output)] = '\0';
+	fclose(output);
+
+	return content;
+}
+
+
+static const char *My_expected =
+	"suite:\n"
+	"	test2:\n"
+	"		[INFO] My message\n"
+	"		[FAIL] My failure\n"
+	"	test2 failed.\n"
+	"suite failed.\n"
+	"Unit tests summary: 1 failed, 2 passed.\n";
+
+
+
+/** Asynchronous output is off by default.
+ */
+static void default_test(Cutl *cutl, Fixture *fix)
+{
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_async(fix->cutl));
+}
+
+
+/** Lines are all written, in order, once the summary is printed.
+ */
+static void summary_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_async(fix->cutl, true);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_async(fix->cutl));
+	cutl_assert_content(cutl, fix->output, My_expected);
+}
+
+
+/** Output is the same whether it is written asynchronously or not.
+ */
+static void sync_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	const char *expected = My_output(cutl, false);
+
+	// Function under test
+	const char *content = My_output(cutl, true);
+
+	// Asserts
+	cutl_assert(cutl, strcmp(content, expected) == 0, "Output differs.");
+}
+
+
+/** Lines wait for room in the queue rather than being dropped.
+ */
+static void long_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_async(fix->cutl, true);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_long_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	char line[64];
+	int count = 0;
+	rewind(fix->output);
+	while (fgets(line, sizeof(line), fix->output) != NULL) {
+		int index;
+		if (sscanf(line, "\t[INFO] Line %d", &index) == 1) {
+			cutl_assert_equal(cutl, index, count);
+			count++;
+		}
+	}
+	cutl_assert_equal(cutl, count, NB_LINES);
+}
+
+
+/** Lines are written before the output is flushed for a new worker.
+ */
+static void jobs_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_async(fix->cutl, true);
+	cutl_set_jobs(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	cutl_assert_content(cutl, fix->output, My_expected);
+}
+
+
+/** Lines of tests run on threads are queued when they are replayed.
+ */
+static void parallel_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_async(fix->cutl, true);
+	cutl_set_parallel(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	cutl_assert_content(cutl, fix->output, My_expected);
+}
+
+
+/** Queued lines are written before output is written directly again.
+ */
+static void off_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_async(fix->cutl, true);
+	cutl_run(fix->cutl, "test1", My_fail_test, NULL);
+
+	// Function under test
+	cutl_set_async(fix->cutl, false);
+	cutl_run(fix->cutl, "test2", My_fail_test, NULL);
+
+	// Asserts
+	const char *expected =
+		"test1:\n"
+		"	[INFO] My message\n"
+		"	[FAIL] My failure\n"
+		"test1 failed.\n"
+		"test2:\n"
+		"	[INFO] My message\n"
+		"	[FAIL] My failure\n"
+		"test2 failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+
+// ASYNC SUITE
+
+void cutl_async_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, default_test);
+
+#ifdef CUTL_USE_PTHREAD
+	cutl_test(cutl, summary_test);
+	cutl_test(cutl, sync_test);
+	cutl_test(cutl, long_test);
+	cutl_test(cutl, parallel_test);
+	cutl_test(cutl, off_test);
+#endif
+
+#if defined(CUTL_USE_PTHREAD) && defined(CUTL_USE_FORK)
+	cutl_test(cutl, jobs_test);
+#endif
+}
@@ -0,0 +1,381 @@
+#include "tests.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+
+// MY TEST FUNCTIONS
+
+static void My_count_bench(Cutl *cutl, void *data)
+{
+	long *count = data;
+	(*count)++;
+}
+
+static void My_fail_bench(Cutl *cutl, void *data)
+{
+	long *count = data;
+	(*count)++;
+	cutl_fail_at(cutl, NULL, 0, "Hard Failure");
+}
+
+// About a thousand times slower than counting.
+static void My_slow_bench(Cutl *cutl, void *data)
+{
+	for (volatile int i=0; i<1000; ++i);
+	My_count_bench(cutl, data);
+}
+
+static void My_bench_suite(Cutl *cutl, void *data)
+{
+	cutl_bench(cutl, "bench", My_count_bench, data);
+}
+
+
+// Writes the baseline of the benchmark in a separate tree of tests.
+static void My_take_baseline(
+	Cutl *cutl, const char *path, const char *name, Cutl_Func *func)
+{
+	long calls = 0;
+	Cutl *other = cutl_new(NULL);
+	cutl_check(cutl, other != NULL, "Could not create test context.");
+	cutl_set_verbosity(other, CUTL_SILENT);
+	cutl_set_baseline(other, path);
+	cutl_bench(other, name, func, &calls);
+	cutl_summary(other);
+	cutl_free(other);
+}
+
+
+static void My_read(FILE *input, char *content, size_t size)
+{
+	rewind(input);
+	content[fread(content, 1, size - 1, input)] = '\0';
+}
+
+
+// Checks the output, where the statistics of the benchmark are formatted in
+// place of "%s", and returns the number of calls per sample.
+static long My_check_report(Cutl *cutl, FILE *output, const char *format)
+{
+	char content[512];
+	My_read(output, content, sizeof(content));
+
+	const char *after = strstr(content, "[INFO] ");
+	cutl_assert(cutl, after != NULL, "Statistics not reported.");
+
+	double mean, median, stddev, min;
+	int samples;
+	long count;
+	const int nb_fields = sscanf(
+		after, "[INFO] %lf ns/op (median %lf, stddev %lf, min %lf) over"
+		" %d x %ld calls.", &mean, &median, &stddev, &min, &samples,
+		&count
+	);
+	cutl_assert_equal(cutl, nb_fields, 6);
+	cutl_assert(cutl, min <= median, "Minimum above median.");
+	cutl_assert(cutl, min <= mean, "Minimum above mean.");
+	cutl_assert(cutl, stddev >= 0, "Negative deviation.");
+	cutl_assert_equal(cutl, samples, 10);
+
+	char stats[256];
+	sprintf(
+		stats, "%.2f ns/op (median %.2f, stddev %.2f, min %.2f) over"
+		" %d x %ld calls.", mean, median, stddev, min, samples, count
+	);
+
+	char expected[512];
+	sprintf(expected, format, stats);
+	cutl_assert_content(cutl, output, expected);
+
+	return count;
+}
+
+
+
+/** Benchmarks report statistics of their calls.
+ */
+static void report_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	long calls = 0;
+
+	// Function under test
+	int failed = cutl_bench(fix->cutl, "bench", My_count_bench, &calls);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+
+	const long count = My_check_report(
+		cutl, fix->output,
+		"bench:\n"
+		"	[INFO] %s\n"
+		"bench passed.\n"
+	);
+
+	// Calibration calls included.
+	cutl_assert(cutl, count > 1, "Calls not calibrated.");
+	cutl_assert(cutl, calls > 10 * count, "Called %ld times.", calls);
+}
+
+
+/** Benchmarks nest inside suites.
+ */
+static void suite_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	long calls = 0;
+
+	// Function under test
+	cutl_run_as_suite(fix->cutl, "suite", My_bench_suite, &calls);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+
+	My_check_report(
+		cutl, fix->output,
+		"suite:\n"
+		"	bench:\n"
+		"		[INFO] %s\n"
+		"	bench passed.\n"
+		"suite passed.\n"
+	);
+}
+
+
+/** Failing benchmarks stop and report nothing else.
+ */
+static void fail_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	long calls = 0;
+
+	// Function under test
+	int failed = cutl_bench(fix->cutl, "bench", My_fail_bench, &calls);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 1);
+	cutl_assert_equal(cutl, calls, 1);
+
+	const char *expected =
+		"bench:\n"
+		"	[FAIL] Hard Failure\n"
+		"bench failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Statistics follow the verbosity.
+ */
+static void silent_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	long calls = 0;
+	cutl_set_verbosity(fix->cutl, CUTL_MINIMAL);
+
+	// Function under test
+	cutl_bench(fix->cutl, "bench", My_count_bench, &calls);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_content(cutl, fix->output, "");
+}
+
+
+/** Benchmarks are run by the calling process, not by parallel jobs.
+ */
+static void jobs_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	long calls = 0;
+	cutl_set_jobs(fix->cutl, 2);
+	cutl_set_parallel(fix->cutl, 2);
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+
+	// Function under test
+	int failed = cutl_bench(fix->cutl, "bench", My_count_bench, &calls);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+	cutl_assert(cutl, calls > 0, "Benchmark not run inline.");
+}
+
+
+
+/** Benchmarks slower than their baseline fail.
+ */
+static void regression_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	My_take_baseline(cutl, path, "bench", My_count_bench);
+	long calls = 0;
+	cutl_set_baseline(fix->cutl, path);
+
+	// Function under test
+	int failed = cutl_bench(fix->cutl, "bench", My_slow_bench, &calls);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 1);
+
+	char content[512];
+	My_read(fix->output, content, sizeof(content));
+	cutl_assert(
+		cutl, strstr(content, "\t[FAIL] Slower than baseline by ")
+		!= NULL, "Regression not reported."
+	);
+	cutl_assert(
+		cutl, strstr(content, "\nbench failed.\n") != NULL,
+		"Benchmark did not fail."
+	);
+
+	// Cleanup
+	remove(path);
+}
+
+
+/** Benchmarks faster than their baseline pass.
+ */
+static void faster_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	My_take_baseline(cutl, path, "bench", My_slow_bench);
+	long calls = 0;
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+	cutl_set_baseline(fix->cutl, path);
+
+	// Function under test
+	int failed = cutl_bench(fix->cutl, "bench", My_count_bench, &calls);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+
+	// Cleanup
+	remove(path);
+}
+
+
+/** Slowdowns below the threshold pass.
+ */
+static void threshold_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	My_take_baseline(cutl, path, "bench", My_count_bench);
+	long calls = 0;
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+	cutl_set_baseline(fix->cutl, path);
+
+	// Function under test
+	cutl_set_regression(fix->cutl, 1000000);
+	int failed = cutl_bench(fix->cutl, "bench", My_slow_bench, &calls);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+
+	// Cleanup
+	remove(path);
+}
+
+
+/** Baselines are kept, new benchmarks are added.
+ */
+static void keep_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	My_take_baseline(cutl, path, "bench", My_slow_bench);
+	FILE *file = fopen(path, "r");
+	cutl_check(cutl, file != NULL, "Could not open baseline file.");
+	char before[512];
+	My_read(file, before, sizeof(before));
+	fclose(file);
+
+	long calls = 0;
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+	cutl_set_baseline(fix->cutl, path);
+	cutl_bench(fix->cutl, "bench", My_count_bench, &calls);
+	cutl_bench(fix->cutl, "other", My_count_bench, &calls);
+
+	// Function under test
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	file = fopen(path, "r");
+	cutl_assert(cutl, file != NULL, "No baseline file.");
+	char after[1024];
+	My_read(file, after, sizeof(after));
+	fclose(file);
+
+	cutl_assert(cutl, strstr(after, before) != NULL, "Baseline replaced.");
+	cutl_assert(cutl, strstr(after, " other\n") != NULL, "Not added.");
+
+	// Cleanup
+	remove(path);
+}
+
+
+
+/** Events are counted next to the timings, when the system allows it.
+ */
+static void counters_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	long calls = 0;
+	cutl_set_counters(fix->cutl, true);
+
+	// Function under test
+	int failed = cutl_bench(fix->cutl, "bench", My_count_bench, &calls);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+
+	char content[1024];
+	My_read(fix->output, content, sizeof(content));
+	const char *line = strstr(content, " calls.\n");
+	cutl_assert(cutl, line != NULL, "Timings not reported.");
+	line += strlen(" calls.\n");
+
+	if (strcmp(line, "bench passed.\n") != 0) {
+		double first;
+		char unit[16];
+		cutl_assert_equal(
+			cutl, sscanf(line, "\t[INFO] %lf %15s", &first, unit), 2
+		);
+		cutl_assert(
+			cutl, strcmp(unit, "cycles/op,") == 0
+			|| strcmp(unit, "task-clock") == 0, "Unknown events."
+		);
+	}
+}
+
+
+
+// BENCH SUITE
+
+void cutl_bench_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, report_test);
+	cutl_test(cutl, suite_test);
+	cutl_test(cutl, fail_test);
+	cutl_test(cutl, silent_test);
+	cutl_test(cutl, jobs_test);
+	cutl_test(cutl, regression_test);
+	cutl_test(cutl, faster_test);
+	cutl_test(cutl, threshold_test);
+	cutl_test(cutl, keep_test);
+
+#ifdef CUTL_USE_PERF_EVENT
+	cutl_test(cutl, counters_test);
+#endif
+}
@@ -0,0 +1,182 @@
+#include "tests.h"
+
+
+
+// MY TEST FUNCTIONS
+
+enum { NB_TESTS = 3 };
+
+static const char * const My_names[NB_TESTS] = {"test1", "test2", "other"};
+
+static void My_count_test(Cutl *cutl, void *data)
+{
+	int *count = data;
+	(*count)++;
+}
+
+static void My_count_suite(Cutl *cutl, void *data)
+{
+	int *counts = data;
+	counts[NB_TESTS]++;
+	for (int i=0; i<NB_TESTS; ++i) {
+		cutl_run(cutl, My_names[i], My_count_test, &counts[i]);
+	}
+}
+
+static void My_nested_suite(Cutl *cutl, void *data)
+{
+	cutl_run_as_suite(cutl, "suite", My_count_suite, data);
+}
+
+
+// Runs the suite with the patterns, and checks which tests were run.
+static void My_check(
+	Cutl *cutl, Fixture *fix, const char *included, const char *excluded,
+	const int expected[NB_TESTS + 1])
+{
+	int counts[NB_TESTS + 1] = {0};
+	if (included) cutl_add_filter(fix->cutl, included, false);
+	if (excluded) cutl_add_filter(fix->cutl, excluded, true);
+
+	cutl_run_as_suite(fix->cutl, "nested", My_nested_suite, counts);
+
+	for (int i=0; i<NB_TESTS; ++i) {
+		cutl_assert(
+			cutl, counts[i] == expected[i], "Test %s run %d times.",
+			My_names[i], counts[i]
+		);
+	}
+	cutl_assert(
+		cutl, counts[NB_TESTS] == expected[NB_TESTS],
+		"Suite run %d times.", counts[NB_TESTS]
+	);
+}
+
+
+
+/** Only the tests matching a pattern are run.
+ */
+static void include_test(Cutl *cutl, Fixture *fix)
+{
+	// Function under test
+	My_check(
+		cutl, fix, "nested/suite/test2", NULL, (int[]) {0, 1, 0, 1}
+	);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 0);
+}
+
+
+/** Tests matching an excluded pattern are not run.
+ */
+static void exclude_test(Cutl *cutl, Fixture *fix)
+{
+	// Function under test
+	My_check(
+		cutl, fix, NULL, "nested/suite/test2", (int[]) {1, 0, 1, 1}
+	);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 2);
+}
+
+
+/** Stars match any characters but slashes, question marks a single one.
+ */
+static void star_test(Cutl *cutl, Fixture *fix)
+{
+	My_check(cutl, fix, "nested/*/test?", NULL, (int[]) {1, 1, 0, 1});
+}
+
+
+/** Double stars also match slashes.
+ */
+static void double_star_test(Cutl *cutl, Fixture *fix)
+{
+	My_check(cutl, fix, "**/other", NULL, (int[]) {0, 0, 1, 1});
+}
+
+
+/** Stars do not match slashes.
+ */
+static void star_slash_test(Cutl *cutl, Fixture *fix)
+{
+	My_check(cutl, fix, "*/other", NULL, (int[]) {0, 0, 0, 0});
+}
+
+
+/** Patterns matching a suite match all of its tests.
+ */
+static void suite_test(Cutl *cutl, Fixture *fix)
+{
+	My_check(cutl, fix, "nested/suite", NULL, (int[]) {1, 1, 1, 1});
+}
+
+
+/** Excluded suites are not run at all.
+ */
+static void exclude_suite_test(Cutl *cutl, Fixture *fix)
+{
+	My_check(cutl, fix, NULL, "nested/suite", (int[]) {0, 0, 0, 0});
+}
+
+
+/** Tests are filtered before their `at_start` function is called.
+ */
+static void fixture_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int starts = 0, count = 0;
+	cutl_at_start(fix->cutl, My_count_test, &starts);
+	cutl_add_filter(fix->cutl, "test", false);
+
+	// Function under test
+	cutl_run(fix->cutl, "other", My_count_test, &count);
+	cutl_run(fix->cutl, "test", My_count_test, &count);
+
+	// Asserts
+	cutl_assert_equal(cutl, starts, 1);
+	cutl_assert_equal(cutl, count, 1);
+}
+
+
+/** Patterns can be removed.
+ */
+static void remove_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_add_filter(fix->cutl, "nested/suite/test2", false);
+	cutl_add_filter(fix->cutl, "nested/suite/other", true);
+
+	// Function under test
+	cutl_add_filter(fix->cutl, NULL, false);
+
+	// Asserts
+	cutl_assert(
+		cutl, cutl_get_filter(fix->cutl, 0, NULL) == NULL,
+		"Pattern not removed."
+	);
+	My_check(cutl, fix, NULL, NULL, (int[]) {1, 1, 1, 1});
+}
+
+
+
+// FILTER SUITE
+
+void cutl_filter_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, include_test);
+	cutl_test(cutl, exclude_test);
+	cutl_test(cutl, star_test);
+	cutl_test(cutl, double_star_test);
+	cutl_test(cutl, star_slash_test);
+	cutl_test(cutl, suite_test);
+	cutl_test(cutl, exclude_suite_test);
+	cutl_test(cutl, fixture_test);
+	cutl_test(cutl, remove_test);
+}
@@ -0,0 +1,224 @@
+#include "tests.h"
+
+#include <stdlib.h>
+#include <limits.h>
+
+
+
+// MY TEST FUNCTIONS
+
+static void My_pass_test(Cutl *cutl, void *data)
+{
+	cutl_assert_true(cutl, true);
+}
+
+// The first page is never mapped.
+static void My_segv_test(Cutl *cutl, void *data)
+{
+	volatile int *ptr = (volatile int*) sizeof(int);
+	*ptr = 1;
+	cutl_fail_at(cutl, NULL, 0, "Did not crash.");
+}
+
+static void My_abort_test(Cutl *cutl, void *data)
+{
+	abort();
+}
+
+// Not a tail call, so that it can't be turned into a loop.
+static int My_recurse(volatile char *previous, long depth)
+{
+	volatile char frame[256];
+	frame[0] = previous != NULL ? previous[0] + 1 : 0;
+	if (depth == 0) return frame[0];
+	return My_recurse(frame, depth - 1) + frame[1];
+}
+
+static void My_overflow_test(Cutl *cutl, void *data)
+{
+	My_recurse(NULL, LONG_MAX);
+	cutl_fail_at(cutl, NULL, 0, "Did not crash.");
+}
+
+static void My_crash_suite(Cutl *cutl, void *data)
+{
+	cutl_run(cutl, "test1", My_segv_test, NULL);
+	cutl_run(cutl, "test2", My_pass_test, NULL);
+}
+
+
+
+/** Crashes fail the test.
+ */
+static void segv_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_guard(fix->cutl, CUTL_FAIL);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_segv_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 1);
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+
+	const char *expected =
+		"test:\n"
+		"	[FAIL] Crashed with signal SIGSEGV.\n"
+		"test failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Aborting fails the test.
+ */
+static void abort_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_guard(fix->cutl, CUTL_FAIL);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_abort_test, NULL);
+	cutl_run(fix->cutl, "other", My_pass_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+
+	const char *expected =
+		"test:\n"
+		"	[FAIL] Crashed with signal SIGABRT.\n"
+		"test failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Stack overflows are caught.
+ */
+static void overflow_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_guard(fix->cutl, CUTL_FAIL);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_overflow_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 1);
+
+	const char *expected =
+		"test:\n"
+		"	[FAIL] Crashed with signal SIGSEGV.\n"
+		"test failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Crashes reported as errors cancel the rest of the sequence.
+ */
+static void error_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_guard(fix->cutl, CUTL_ERROR);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_crash_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 0);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+
+	const char *expected =
+		"suite:\n"
+		"	test1:\n"
+		"		[ERROR] Crashed with signal SIGSEGV.\n"
+		"	test1 canceled.\n"
+		"suite canceled.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Crashes in tests run on threads fail the test.
+ */
+static void parallel_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_guard(fix->cutl, CUTL_FAIL);
+	cutl_set_parallel(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_segv_test, NULL);
+	cutl_run(fix->cutl, "other", My_pass_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+
+	const char *expected =
+		"test:\n"
+		"	[FAIL] Crashed with signal SIGSEGV.\n"
+		"test failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Crashes in workers fail the test.
+ */
+static void jobs_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_guard(fix->cutl, CUTL_FAIL);
+	cutl_set_jobs(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_abort_test, NULL);
+	cutl_run(fix->cutl, "other", My_pass_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+
+	const char *expected =
+		"test:\n"
+		"	[FAIL] Crashed with signal SIGABRT.\n"
+		"test failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Crashes are not handled by default.
+ */
+static void default_test(Cutl *cutl, Fixture *fix)
+{
+	// Function under test
+	cutl_set_guard(fix->cutl, CUTL_WARN);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_guard(fix->cutl), 0);
+}
+
+
+
+// GUARD SUITE
+
+void cutl_guard_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, default_test);
+
+#ifdef CUTL_USE_SIGACTION
+	cutl_test(cutl, segv_test);
+	cutl_test(cutl, abort_test);
+	cutl_test(cutl, overflow_test);
+	cutl_test(cutl, error_test);
+	cutl_test(cutl, parallel_test);
+#endif
+
+#if defined(CUTL_USE_SIGACTION) && defined(CUTL_USE_FORK)
+	cutl_test(cutl, jobs_test);
+#endif
+}
@@ -0,0 +1,249 @@
+#include "tests.h"
+
+#include <string.h>
+
+#ifdef CUTL_INCREMENTAL_ENABLED
+
+// Called by functions built with `-finstrument-functions`, here by hand.
+void __cyg_profile_func_enter(void *func, void *call_site);
+
+
+
+// MY TEST FUNCTIONS
+
+enum { NB_TESTS = 4 };
+
+static int My_covered(int value)
+{
+	__cyg_profile_func_enter((void*) My_covered, NULL);
+	return value + 1;
+}
+
+static void My_covered_test(Cutl *cutl, void *data)
+{
+	int *count = data;
+	*count = My_covered(*count);
+}
+
+static void My_failed_test(Cutl *cutl, void *data)
+{
+	My_covered_test(cutl, data);
+	cutl_fail_at(cutl, NULL, 0, "My failure");
+}
+
+static void My_uncovered_test(Cutl *cutl, void *data)
+{
+	int *count = data;
+	(*count)++;
+}
+
+static void My_nested_test(Cutl *cutl, void *data)
+{
+	cutl_run(cutl, "inner", My_covered_test, data);
+}
+
+
+// Runs the tests with the cache, and counts the runs of each.
+static void My_run(Cutl *cutl, const char *path, int counts[NB_TESTS])
+{
+	cutl_set_verbosity(cutl, CUTL_SILENT);
+	cutl_set_cache(cutl, path);
+	cutl_set_incremental(cutl, true);
+
+	cutl_run(cutl, "covered", My_covered_test, &counts[0]);
+	cutl_run(cutl, "failed", My_failed_test, &counts[1]);
+	cutl_run(cutl, "uncovered", My_uncovered_test, &counts[2]);
+	cutl_run(cutl, "nested", My_nested_test, &counts[3]);
+}
+
+
+// Runs the tests once to cache what they covered.
+static void My_train(const char *path, bool is_isolated)
+{
+	int counts[NB_TESTS] = {0};
+	Cutl *cutl = cutl_new(NULL);
+	cutl_set_isolated(cutl, is_isolated);
+	My_run(cutl, path, counts);
+	cutl_summary(cutl);
+	cutl_free(cutl);
+}
+
+
+// Returns the number of functions the test covered in the cache file, or -1.
+static int My_nb_functions(const char *path, const char *name)
+{
+	FILE *file = fopen(path, "r");
+	if (file == NULL) return -1;
+
+	char line[256];
+	int count = -1;
+	while (fgets(line, sizeof(line), file) != NULL) {
+		line[strcspn(line, "\n")] = '\0';
+		const char *space = strrchr(line, ' ');
+		if (space == NULL || strcmp(space + 1, name) != 0) continue;
+
+		if (sscanf(line, "%*x %*f %*c %*x %d", &count) != 1) count = -1;
+	}
+	fclose(file);
+	return count;
+}
+
+
+// Changes the fingerprint of the test in the cache file, as if the code it
+// covered had changed.
+static void My_change(Cutl *cutl, const char *path, const char *name)
+{
+	char lines[8][256];
+	int nb_lines = 0;
+	FILE *file = fopen(path, "r");
+	cutl_check(cutl, file != NULL, "No cache file.");
+	while (nb_lines < 8
+		&& fgets(lines[nb_lines], sizeof(lines[0]), file) != NULL
+	) {
+		lines[nb_lines][strcspn(lines[nb_lines], "\n")] = '\0';
+		nb_lines++;
+	}
+	fclose(file);
+
+	file = fopen(path, "w");
+	cutl_check(cutl, file != NULL, "Could not open cache file.");
+	for (int i=0; i<nb_lines; ++i) {
+		const char *space = strrchr(lines[i], ' ');
+		unsigned long key, fingerprint;
+		double duration;
+		char status;
+		int end;
+		if (space != NULL && strcmp(space + 1, name) == 0
+			&& sscanf(
+				lines[i], "%lx %lf %c %lx%n", &key, &duration,
+				&status, &fingerprint, &end
+			) == 4
+		) {
+			fprintf(
+				file, "%08lx %f %c %08lx%s\n", key, duration,
+				status, fingerprint ^ 1, lines[i] + end
+			);
+		} else {
+			fprintf(file, "%s\n", lines[i]);
+		}
+	}
+	fclose(file);
+}
+
+
+
+// INCREMENTAL TESTING
+
+/** Tests that passed are skipped while the code they covered is unchanged,
+ * unless they covered nothing.
+ */
+static void skip_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	My_train(path, false);
+	int counts[NB_TESTS] = {0};
+
+	// Function under test
+	My_run(fix->cutl, path, counts);
+
+	// Asserts
+	cutl_assert_equal(cutl, counts[0], 0);
+	cutl_assert_equal(cutl, counts[1], 1);
+	cutl_assert_equal(cutl, counts[2], 1);
+	cutl_assert_equal(cutl, counts[3], 0);
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+
+	// Cleanup
+	remove(path);
+}
+
+
+/** Functions covered by each test are cached, those of nested tests included.
+ */
+static void cache_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+
+	// Function under test
+	My_train(path, false);
+
+	// Asserts
+	cutl_assert_equal(cutl, My_nb_functions(path, "covered"), 1);
+	cutl_assert_equal(cutl, My_nb_functions(path, "uncovered"), 0);
+	cutl_assert_equal(cutl, My_nb_functions(path, "nested"), 1);
+	cutl_assert_equal(cutl, My_nb_functions(path, "nested/inner"), -1);
+
+	// Cleanup
+	remove(path);
+}
+
+
+/** Tests are run again once the code they covered changed.
+ */
+static void changed_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	My_train(path, false);
+	My_change(cutl, path, "covered");
+	int counts[NB_TESTS] = {0};
+
+	// Function under test
+	My_run(fix->cutl, path, counts);
+
+	// Asserts
+	cutl_assert_equal(cutl, counts[0], 1);
+	cutl_assert_equal(cutl, counts[3], 0);
+
+	// Cleanup
+	remove(path);
+}
+
+
+/** Tests run in jobs send back the functions they covered.
+ */
+static void isolated_test(Cutl *cutl, Fixture *fix)
+{
+#ifdef CUTL_USE_FORK
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+
+	// Function under test
+	My_train(path, true);
+
+	// Asserts
+	cutl_assert_equal(cutl, My_nb_functions(path, "covered"), 1);
+	cutl_assert_equal(cutl, My_nb_functions(path, "nested"), 1);
+
+	// Cleanup
+	remove(path);
+#endif
+}
+
+
+
+// INCREMENTAL SUITE
+
+void cutl_incremental_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, skip_test);
+	cutl_test(cutl, cache_test);
+	cutl_test(cutl, changed_test);
+	cutl_test(cutl, isolated_test);
+}
+
+#else
+
+void cutl_incremental_suite(Cutl *cutl) {}
+
+#endif
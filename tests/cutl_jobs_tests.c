@@ -0,0 +1,366 @@
+#include "tests.h"
+
+#include <stdlib.h>
+#include <signal.h>
+
+
+
+// MY TEST FUNCTIONS
+
+static void My_pass_test(Cutl *cutl, void *data)
+{
+	cutl_assert_true(cutl, true);
+}
+
+static void My_fail_test(Cutl *cutl, void *data)
+{
+	cutl_message_at(cutl, CUTL_INFO, NULL, 0, "My message");
+	cutl_fail_at(cutl, NULL, 0, "My failure");
+}
+
+static void My_error_test(Cutl *cutl, void *data)
+{
+	cutl_error_at(cutl, NULL, 0, "My error");
+}
+
+static void My_exit_test(Cutl *cutl, void *data)
+{
+	exit(3);
+}
+
+static void My_state_test(Cutl *cutl, void *data)
+{
+	int *state = data;
+	(*state)++;
+}
+
+static void My_kill_test(Cutl *cutl, void *data)
+{
+	cutl_message_at(cutl, CUTL_INFO, NULL, 0, "My message");
+	raise(SIGKILL);
+}
+
+// Set up once by the server suite.
+static int My_dataset;
+
+static void My_dataset_test(Cutl *cutl, void *data)
+{
+	cutl_assert_equal(cutl, My_dataset, 42);
+	My_dataset = 0;
+}
+
+static void My_server_suite(Cutl *cutl, void *data)
+{
+	My_dataset = 42;
+	cutl_message_at(cutl, CUTL_INFO, NULL, 0, "Setup");
+	cutl_run(cutl, "test1", My_dataset_test, NULL);
+	cutl_run(cutl, "test2", My_dataset_test, NULL);
+	cutl_run(cutl, "test3", My_exit_test, NULL);
+}
+
+enum { NB_INDICES = 100 };
+
+static void My_index_test(Cutl *cutl, void *data)
+{
+	int *index = data;
+	cutl_message_at(cutl, CUTL_INFO, NULL, 0, "%d", *index);
+}
+
+static void My_index_suite(Cutl *cutl, void *data)
+{
+	int *indices = data;
+	for (int i=0; i<NB_INDICES; ++i) {
+		indices[i] = i;
+		cutl_run(cutl, "test", My_index_test, &indices[i]);
+	}
+}
+
+static void My_subsuite(Cutl *cutl, void *data)
+{
+	cutl_run(cutl, "test1", My_pass_test, NULL);
+	cutl_run(cutl, "test2", My_fail_test, NULL);
+}
+
+static void My_suite(Cutl *cutl, void *data)
+{
+	cutl_run(cutl, "test1", My_pass_test, NULL);
+	cutl_run(cutl, "subsuite1", My_subsuite, NULL);
+	cutl_run_as_suite(cutl, "subsuite2", My_subsuite, NULL);
+	cutl_run(cutl, "test2", My_pass_test, NULL);
+}
+
+static void My_state_suite(Cutl *cutl, void *data)
+{
+	int *state = data;
+	(*state)++;
+	cutl_run(cutl, "test", My_state_test, data);
+}
+
+
+
+/** Output looks the same as when tests are run one after the other.
+ */
+static void output_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_verbosity(fix->cutl, CUTL_VERBOSE ^ CUTL_TIMES);
+	cutl_set_jobs(fix->cutl, 3);
+
+	// Function under test
+	cutl_run_as_suite(fix->cutl, "suite", My_suite, NULL);
+
+	// Asserts
+	const char *expected =
+		"suite:\n"
+		"	test1 passed.\n"
+		"	subsuite1:\n"
+		"		test1 passed.\n"
+		"		test2:\n"
+		"			[INFO] My message\n"
+		"			[FAIL] My failure\n"
+		"		test2 failed.\n"
+		"	subsuite1 failed.\n"
+		"	subsuite2:\n"
+		"		test1 passed.\n"
+		"		test2:\n"
+		"			[INFO] My message\n"
+		"			[FAIL] My failure\n"
+		"		test2 failed.\n"
+		"	subsuite2 failed.\n"
+		"	test2 passed.\n"
+		"suite failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+
+	cutl_assert_equal(cutl, cutl_get_children(fix->cutl), 6);
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 4);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 2);
+}
+
+
+/** Flattened output looks the same as when tests are run one after the other.
+ */
+static void flattened_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_verbosity(fix->cutl, CUTL_FAIL);
+	cutl_set_jobs(fix->cutl, 3);
+
+	// Function under test
+	cutl_run_as_suite(fix->cutl, "suite", My_suite, NULL);
+
+	// Asserts
+	const char *expected =
+		"test2:\n"
+		"	[FAIL] My failure\n"
+		"test2 failed.\n"
+		"test2:\n"
+		"	[FAIL] My failure\n"
+		"test2 failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 2);
+}
+
+
+/** Suites are run in the current process, tests by workers.
+ */
+static void suite_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int state = 0;
+	cutl_set_jobs(fix->cutl, 2);
+
+	// Function under test
+	cutl_run_as_suite(fix->cutl, "suite", My_state_suite, &state);
+
+	// Asserts
+	cutl_assert_equal(cutl, state, 1);
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 0);
+}
+
+
+/** Workers that exit are failures.
+ */
+static void exit_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_verbosity(fix->cutl, CUTL_FAIL);
+	cutl_set_jobs(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "test1", My_exit_test, NULL);
+	cutl_run(fix->cutl, "test2", My_pass_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+
+	const char *expected =
+		"test1:\n"
+		"	[FAIL] Worker exited with status 3.\n"
+		"test1 failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Errors cancel the rest of the test sequence.
+ */
+static void error_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+	cutl_set_jobs(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "test1", My_pass_test, NULL);
+	cutl_run(fix->cutl, "test2", My_error_test, NULL);
+	cutl_run(fix->cutl, "test3", My_pass_test, NULL);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_children(fix->cutl), 2);
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+}
+
+
+/** Tests canceled by an earlier error do not print their output.
+ */
+static void error_output_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_jobs(fix->cutl, 3);
+
+	// Function under test
+	cutl_run(fix->cutl, "test1", My_error_test, NULL);
+	cutl_run(fix->cutl, "test2", My_fail_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	const char *expected =
+		"test1:\n"
+		"	[ERROR] My error\n"
+		"test1 canceled.\n"
+		"Unit tests summary: canceled.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Isolated tests run in their own process, one after the other.
+ */
+static void isolated_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int state = 0;
+	cutl_set_isolated(fix->cutl, true);
+
+	// Function under test
+	cutl_run(fix->cutl, "test1", My_state_test, &state);
+	cutl_run(fix->cutl, "test2", My_exit_test, NULL);
+	cutl_run(fix->cutl, "test3", My_state_test, &state);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 2);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_jobs(fix->cutl), 1);
+	cutl_assert_equal(cutl, state, 0);
+}
+
+
+/** Output written before a worker dies is kept.
+ */
+static void killed_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_isolated(fix->cutl, true);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_kill_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+
+	char expected[128];
+	sprintf(
+		expected, "test:\n\t[INFO] My message\n\t[FAIL] Worker killed "
+		"by signal %d.\ntest failed.\n", SIGKILL
+	);
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Output stays in order when more jobs are pending than can be buffered in
+ * shared memory.
+ */
+static void many_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	static int indices[NB_INDICES];
+	cutl_set_verbosity(fix->cutl, CUTL_VERBOSE ^ CUTL_TIMES);
+	cutl_set_jobs(fix->cutl, 4);
+
+	// Function under test
+	cutl_run_as_suite(fix->cutl, "suite", My_index_suite, indices);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), NB_INDICES);
+
+	static char expected[NB_INDICES * 64];
+	char *end = expected + sprintf(expected, "suite:\n");
+	for (int i=0; i<NB_INDICES; ++i) {
+		end += sprintf(
+			end, "\ttest:\n\t\t[INFO] %d\n\ttest passed.\n", i
+		);
+	}
+	sprintf(end, "suite passed.\n");
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Servers set up once and fork each of their tests.
+ */
+static void server_test(Cutl *cutl, Fixture *fix)
+{
+	// Function under test
+	cutl_run_as_server(fix->cutl, "suite", My_server_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 3);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+	cutl_assert_equal(cutl, My_dataset, 0);
+
+	const char *expected =
+		"suite:\n"
+		"	[INFO] Setup\n"
+		"	test3:\n"
+		"		[FAIL] Worker exited with status 3.\n"
+		"	test3 failed.\n"
+		"suite failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+
+// JOBS SUITE
+
+void cutl_jobs_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, output_test);
+	cutl_test(cutl, flattened_test);
+	cutl_test(cutl, error_test);
+	cutl_test(cutl, error_output_test);
+
+#ifdef CUTL_USE_FORK
+	cutl_test(cutl, suite_test);
+	cutl_test(cutl, exit_test);
+	cutl_test(cutl, isolated_test);
+	cutl_test(cutl, killed_test);
+	cutl_test(cutl, many_test);
+	cutl_test(cutl, server_test);
+#endif
+}
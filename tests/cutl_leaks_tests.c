@@ -0,0 +1,360 @@
+#include "tests.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+
+// MY TEST FUNCTIONS
+
+// Blocks go through a volatile pointer, so that allocations are not elided.
+static void *volatile My_block;
+
+static void My_leak_test(Cutl *cutl, void *data)
+{
+	void **block = data;
+	*block = My_block = malloc(100);
+}
+
+static void My_free_test(Cutl *cutl, void *data)
+{
+	My_block = malloc(100);
+	free(My_block);
+	My_block = calloc(5, 10);
+	free(My_block);
+}
+
+static void My_realloc_test(Cutl *cutl, void *data)
+{
+	void **block = data;
+	My_block = calloc(10, 10);
+	*block = My_block = realloc(My_block, 200);
+}
+
+// Sizes go through a volatile variable, so that the failure is not foreseen.
+static volatile size_t My_huge_size = SIZE_MAX;
+
+static void My_realloc_fail_test(Cutl *cutl, void *data)
+{
+	void **block = data;
+	*block = My_block = malloc(100);
+	void *moved = realloc(My_block, My_huge_size);
+	cutl_check(cutl, moved == NULL, "Realloc did not fail.");
+}
+
+static void My_free_data_test(Cutl *cutl, void *data)
+{
+	free(data);
+}
+
+static void My_leak_suite(Cutl *cutl, void *data)
+{
+	cutl_run(cutl, "test", My_leak_test, data);
+}
+
+static void My_shared_suite(Cutl *cutl, void *data)
+{
+	My_block = malloc(100);
+	cutl_run(cutl, "test", My_free_data_test, My_block);
+}
+
+
+
+/** Blocks left allocated are reported.
+ */
+static void leak_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	void *block = NULL;
+	cutl_set_leaks(fix->cutl, CUTL_FAIL);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_leak_test, &block);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 1);
+
+	const char *expected =
+		"test:\n"
+		"	[FAIL] Leaked 100 bytes in 1 allocation.\n"
+		"test failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+
+	// Cleanup
+	free(block);
+}
+
+
+/** Blocks that are freed are not reported.
+ */
+static void free_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_leaks(fix->cutl, CUTL_FAIL);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_free_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+	cutl_assert_content(cutl, fix->output, "");
+}
+
+
+/** Reallocated blocks keep being accounted.
+ */
+static void realloc_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	void *block = NULL;
+	cutl_set_leaks(fix->cutl, CUTL_WARN);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_realloc_test, &block);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+
+	const char *expected =
+		"test:\n"
+		"	[WARN] Leaked 200 bytes in 1 allocation.\n"
+		"test passed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+
+	// Cleanup
+	free(block);
+}
+
+
+/** Blocks that could not be reallocated are still accounted.
+ */
+static void realloc_fail_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	void *block = NULL;
+	cutl_set_leaks(fix->cutl, CUTL_WARN);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_realloc_fail_test, &block);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+
+	const char *expected =
+		"test:\n"
+		"	[WARN] Leaked 100 bytes in 1 allocation.\n"
+		"test passed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+
+	// Cleanup
+	free(block);
+}
+
+
+/** Blocks are accounted to the innermost test.
+ */
+static void nested_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	void *block = NULL;
+	cutl_set_leaks(fix->cutl, CUTL_FAIL);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_leak_suite, &block);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+
+	const char *expected =
+		"suite:\n"
+		"	test:\n"
+		"		[FAIL] Leaked 100 bytes in 1 allocation.\n"
+		"	test failed.\n"
+		"suite failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+
+	// Cleanup
+	free(block);
+}
+
+
+/** Blocks can be freed by the tests nested in the one that allocated them.
+ */
+static void shared_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_leaks(fix->cutl, CUTL_FAIL);
+	cutl_set_verbosity(fix->cutl, CUTL_MINIMAL);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_shared_suite, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 0);
+	cutl_assert_content(cutl, fix->output, "");
+}
+
+
+/** Heap peaks are displayed with the durations of tests.
+ */
+static void times_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_leaks(fix->cutl, CUTL_FAIL);
+	cutl_set_verbosity(fix->cutl, CUTL_TESTS | CUTL_TIMES);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_free_test, NULL);
+
+	// Asserts
+	double duration, cpu_duration;
+	rewind(fix->output);
+	const int nb_fields = fscanf(
+		fix->output, "test passed (%lf ms, %lf ms CPU, ", &duration,
+		&cpu_duration
+	);
+	cutl_assert_equal(cutl, nb_fields, 2);
+
+	char expected[256];
+	sprintf(
+		expected, "test passed (%.3f ms, %.3f ms CPU, 100 bytes peak"
+		" in 2 allocations).\n", duration, cpu_duration
+	);
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** The largest heap peak is summarized.
+ */
+static void summary_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	void *block = NULL;
+	cutl_set_leaks(fix->cutl, CUTL_WARN);
+	cutl_set_verbosity(fix->cutl, CUTL_SUMMARY);
+	cutl_run(fix->cutl, "first", My_free_test, NULL);
+	cutl_run(fix->cutl, "second", My_realloc_test, &block);
+	cutl_run(fix->cutl, "third", My_free_test, NULL);
+
+	// Function under test
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	const char *expected =
+		"Unit tests summary: 0 failed, 3 passed.\n"
+		"Largest heap peak: 200 bytes in second.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+
+	// Cleanup
+	free(block);
+}
+
+
+/** Leaks in tests run on threads are reported.
+ */
+static void parallel_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	void *block = NULL;
+	cutl_set_leaks(fix->cutl, CUTL_FAIL);
+	cutl_set_parallel(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_leak_test, &block);
+	cutl_run(fix->cutl, "other", My_free_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+
+	const char *expected =
+		"test:\n"
+		"	[FAIL] Leaked 100 bytes in 1 allocation.\n"
+		"test failed.\n"
+		"Unit tests summary: 1 failed, 1 passed.\n"
+		"Largest heap peak: 100 bytes in test.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+
+	// Cleanup
+	free(block);
+}
+
+
+/** Leaks in workers are reported.
+ */
+static void jobs_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	void *block = NULL;
+	cutl_set_leaks(fix->cutl, CUTL_FAIL);
+	cutl_set_jobs(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_leak_test, &block);
+	cutl_run(fix->cutl, "other", My_free_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+
+	const char *expected =
+		"test:\n"
+		"	[FAIL] Leaked 100 bytes in 1 allocation.\n"
+		"test failed.\n"
+		"Unit tests summary: 1 failed, 1 passed.\n"
+		"Largest heap peak: 100 bytes in test.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Allocations are not accounted by default.
+ */
+static void default_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	void *block = NULL;
+
+	// Function under test
+	cutl_set_leaks(fix->cutl, CUTL_INFO);
+	int failed = cutl_run(fix->cutl, "test", My_leak_test, &block);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_leaks(fix->cutl), 0);
+	cutl_assert_equal(cutl, failed, 0);
+	cutl_assert_content(cutl, fix->output, "");
+
+	// Cleanup
+	free(block);
+}
+
+
+
+// LEAKS SUITE
+
+void cutl_leaks_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, default_test);
+
+#ifdef CUTL_HEAP_ENABLED
+	cutl_test(cutl, leak_test);
+	cutl_test(cutl, free_test);
+	cutl_test(cutl, realloc_test);
+	cutl_test(cutl, realloc_fail_test);
+	cutl_test(cutl, nested_test);
+	cutl_test(cutl, shared_test);
+	cutl_test(cutl, times_test);
+	cutl_test(cutl, summary_test);
+#endif
+
+#if defined(CUTL_HEAP_ENABLED) && defined(CUTL_USE_PTHREAD)
+	cutl_test(cutl, parallel_test);
+#endif
+
+#if defined(CUTL_HEAP_ENABLED) && defined(CUTL_USE_FORK)
+	cutl_test(cutl, jobs_test);
+#endif
+}
@@ -1,5 +1,8 @@
 #include "tests.h"
 
+#include <stdio.h>
+#include <string.h>
+
 
 // MESSAGE TYPE: ERROR
 
@@ -626,6 +629,73 @@ static void flattened_silent_test(Cutl *cutl, Fixture *fix)
 
 
 
+/** Durations of tests test.
+ */
+static void times_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_verbosity(fix->cutl, CUTL_TESTS | CUTL_SUITES | CUTL_TIMES);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_silent_suite, NULL);
+
+	// Asserts
+	double times[3][2];
+	rewind(fix->output);
+	const int nb_fields = fscanf(
+		fix->output,
+		"suite:\n"
+		"	subsuite:\n"
+		"		test passed (%lf ms, %lf ms CPU).\n"
+		"	subsuite passed (%lf ms, %lf ms CPU).\n"
+		"suite passed (%lf ms, %lf ms CPU).\n",
+		&times[0][0], &times[0][1], &times[1][0], &times[1][1],
+		&times[2][0], &times[2][1]
+	);
+	cutl_assert_equal(cutl, nb_fields, 6);
+	for (int i=0; i<3; ++i) {
+		cutl_assert(cutl, times[i][0] >= 0, "Negative duration.");
+		cutl_assert(cutl, times[i][1] >= 0, "Negative CPU time.");
+	}
+	cutl_assert(cutl, times[2][0] >= times[0][0], "Suite not timed.");
+
+	char expected[256];
+	sprintf(
+		expected,
+		"suite:\n"
+		"	subsuite:\n"
+		"		test passed (%.3f ms, %.3f ms CPU).\n"
+		"	subsuite passed (%.3f ms, %.3f ms CPU).\n"
+		"suite passed (%.3f ms, %.3f ms CPU).\n",
+		times[0][0], times[0][1], times[1][0], times[1][1],
+		times[2][0], times[2][1]
+	);
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+
+/** Long messages are not truncated.
+ */
+static void long_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char message[1001];
+	memset(message, 'x', sizeof(message) - 1);
+	message[sizeof(message) - 1] = '\0';
+	cutl_set_verbosity(fix->cutl, CUTL_INFO);
+
+	// Function under test
+	cutl_message_at(fix->cutl, CUTL_INFO, NULL, 0, "%s!", message);
+
+	// Asserts
+	char expected[1024];
+	sprintf(expected, "[INFO] %s!\n", message);
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+
 // MESSAGE SUITE
 
 void cutl_message_suite(Cutl *cutl)
@@ -662,4 +732,6 @@ void cutl_message_suite(Cutl *cutl)
 	cutl_test(cutl, nested_silent_test);
 	cutl_test(cutl, seminested_silent_test);
 	cutl_test(cutl, flattened_silent_test);
+	cutl_test(cutl, times_test);
+	cutl_test(cutl, long_test);
 }
@@ -0,0 +1,271 @@
+#include "tests.h"
+
+#include <time.h>
+
+
+
+// MY TEST FUNCTIONS
+
+static void My_pass_test(Cutl *cutl, void *data)
+{
+	cutl_assert_true(cutl, true);
+}
+
+static void My_fail_test(Cutl *cutl, void *data)
+{
+	cutl_message_at(cutl, CUTL_INFO, NULL, 0, "My message");
+	cutl_fail_at(cutl, NULL, 0, "My failure");
+}
+
+static void My_id_test(Cutl *cutl, void *data)
+{
+	int *id = data;
+	*id = cutl_get_id(cutl);
+}
+
+static void My_start(Cutl *cutl, void *data)
+{
+	cutl_set_data(cutl, data);
+}
+
+static void My_data_test(Cutl *cutl, void *data)
+{
+	cutl_assert(cutl, data != NULL, "No data.");
+	(*(int*) data)++;
+}
+
+static void My_subsuite(Cutl *cutl, void *data)
+{
+	cutl_run(cutl, "test1", My_pass_test, NULL);
+	cutl_run(cutl, "test2", My_fail_test, NULL);
+}
+
+static void My_suite(Cutl *cutl, void *data)
+{
+	cutl_run(cutl, "test1", My_pass_test, NULL);
+	cutl_run(cutl, "subsuite1", My_subsuite, NULL);
+	cutl_run_as_suite(cutl, "subsuite2", My_subsuite, NULL);
+	cutl_run(cutl, "test2", My_pass_test, NULL);
+}
+
+// Data must outlive the suite, which may still run once this one returned.
+static const int My_depths[] = {0, 1, 2, 3};
+
+static void My_deep_suite(Cutl *cutl, void *data)
+{
+	const int *depth = data;
+	if (*depth > 0) {
+		void *next = (void*) (depth - 1);
+		cutl_run_as_suite(cutl, "suite", My_deep_suite, next);
+		cutl_run(cutl, "test", My_pass_test, NULL);
+	}
+}
+
+enum { NB_BUSY = 4 };
+
+// Waits, for a bounded time, until all of its siblings are running.
+static void My_busy_test(Cutl *cutl, void *data)
+{
+	int *running = data;
+	__atomic_add_fetch(running, 1, __ATOMIC_SEQ_CST);
+
+	time_t start = time(NULL);
+	while (__atomic_load_n(running, __ATOMIC_SEQ_CST) < NB_BUSY) {
+		if (time(NULL) - start > 2) {
+			cutl_fail_at(cutl, NULL, 0, "Siblings did not run.");
+		}
+	}
+}
+
+static void My_busy_suite(Cutl *cutl, void *data)
+{
+	for (int i=0; i<NB_BUSY; ++i) {
+		cutl_run(cutl, "test", My_busy_test, data);
+	}
+}
+
+static void My_lopsided_suite(Cutl *cutl, void *data)
+{
+	cutl_run_as_suite(cutl, "busy", My_busy_suite, data);
+	cutl_run(cutl, "test", My_pass_test, NULL);
+}
+
+enum { NB_IDS = 64 };
+
+static void My_id_suite(Cutl *cutl, void *data)
+{
+	int *ids = data;
+	for (int i=0; i<NB_IDS/2; ++i) {
+		cutl_run(cutl, "test", My_id_test, &ids[i]);
+	}
+}
+
+
+
+/** Output looks the same as when tests are run one after the other.
+ */
+static void output_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_verbosity(fix->cutl, CUTL_VERBOSE ^ CUTL_TIMES);
+	cutl_set_parallel(fix->cutl, 4);
+
+	// Function under test
+	cutl_run_as_suite(fix->cutl, "suite", My_suite, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_children(fix->cutl), 6);
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 4);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 2);
+
+	const char *expected =
+		"suite:\n"
+		"	test1 passed.\n"
+		"	subsuite1:\n"
+		"		test1 passed.\n"
+		"		test2:\n"
+		"			[INFO] My message\n"
+		"			[FAIL] My failure\n"
+		"		test2 failed.\n"
+		"	subsuite1 failed.\n"
+		"	subsuite2:\n"
+		"		test1 passed.\n"
+		"		test2:\n"
+		"			[INFO] My message\n"
+		"			[FAIL] My failure\n"
+		"		test2 failed.\n"
+		"	subsuite2 failed.\n"
+		"	test2 passed.\n"
+		"suite failed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Nested suites are displayed depth-first.
+ */
+static void nested_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_verbosity(fix->cutl, CUTL_VERBOSE ^ CUTL_TIMES);
+	cutl_set_parallel(fix->cutl, 3);
+
+	// Function under test
+	void *depth = (void*) &My_depths[3];
+	cutl_run_as_suite(fix->cutl, "suite", My_deep_suite, depth);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 4);
+
+	const char *expected =
+		"suite:\n"
+		"	suite:\n"
+		"		suite:\n"
+		"			suite passed.\n"
+		"			test passed.\n"
+		"		suite passed.\n"
+		"		test passed.\n"
+		"	suite passed.\n"
+		"	test passed.\n"
+		"suite passed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Idle threads steal the tests of a nested suite.
+ */
+static void steal_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int running = 0;
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+	cutl_set_parallel(fix->cutl, NB_BUSY);
+
+	// Function under test
+	cutl_run_as_suite(fix->cutl, "suite", My_lopsided_suite, &running);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), NB_BUSY + 1);
+	cutl_assert_equal(cutl, running, NB_BUSY);
+}
+
+
+/** Identifiers stay unique.
+ */
+static void id_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int ids[NB_IDS] = {0};
+	cutl_set_parallel(fix->cutl, 4);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite1", My_id_suite, ids);
+	cutl_run(fix->cutl, "suite2", My_id_suite, ids + NB_IDS/2);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), NB_IDS);
+	for (int i=0; i<NB_IDS; ++i) {
+		cutl_assert(cutl, ids[i] > 0, "Test %d did not run.", i);
+		for (int j=0; j<i; ++j) {
+			cutl_assert(
+				cutl, ids[i] != ids[j], "Tests %d and %d share "
+				"id %d.", i, j, ids[i]
+			);
+		}
+	}
+}
+
+
+/** Fixtures are the ones set when cutl_run() was called.
+ */
+static void fixture_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int counts[2] = {0};
+	cutl_set_parallel(fix->cutl, 2);
+
+	// Function under test
+	cutl_at_start(fix->cutl, My_start, &counts[0]);
+	cutl_run(fix->cutl, "test1", My_data_test, NULL);
+	cutl_at_start(fix->cutl, My_start, &counts[1]);
+	cutl_run(fix->cutl, "test2", My_data_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 2);
+	cutl_assert_equal(cutl, counts[0], 1);
+	cutl_assert_equal(cutl, counts[1], 1);
+}
+
+
+/** Serial suites stay serial.
+ */
+static void serial_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int count = 0;
+	cutl_set_parallel(fix->cutl, 1);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_data_test, &count);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+	cutl_assert_equal(cutl, count, 1);
+	cutl_assert_equal(cutl, cutl_get_parallel(fix->cutl), 1);
+}
+
+
+
+// PARALLEL SUITE
+
+void cutl_parallel_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, output_test);
+	cutl_test(cutl, nested_test);
+	cutl_test(cutl, steal_test);
+	cutl_test(cutl, id_test);
+	cutl_test(cutl, fixture_test);
+	cutl_test(cutl, serial_test);
+}
@@ -1,5 +1,7 @@
 #include "tests.h"
 
+#include <string.h>
+
 #define ARGC(argv) (sizeof(argv)/sizeof(*argv))
 
 
@@ -199,6 +201,626 @@ static void output_missing_test(Cutl *cutl, Fixture *fix)
 
 
 
+// REPORT OPTION
+
+/** Set report file.
+ */
+static void report_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	char arg[L_tmpnam + 8];
+	sprintf(arg, "junit:%s", path);
+	char *argv[] = {"My_tests", "-R", arg};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_report_format(fix->cutl), CUTL_JUNIT);
+	FILE *report = cutl_get_report(fix->cutl, CUTL_JUNIT);
+	cutl_assert(cutl, report != NULL, "No report file.");
+
+	// Cleanup
+	cutl_set_report(fix->cutl, CUTL_NO_REPORT, NULL);
+	fclose(report);
+	remove(path);
+}
+
+
+/** TAP report.
+ */
+static void report_tap_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	char arg[L_tmpnam + 8];
+	sprintf(arg, "tap:%s", path);
+	char *argv[] = {"My_tests", "-R", arg};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_report_format(fix->cutl), CUTL_TAP);
+	FILE *report = cutl_get_report(fix->cutl, CUTL_TAP);
+	cutl_assert(cutl, report != NULL, "No report file.");
+
+	// Cleanup
+	cutl_set_report(fix->cutl, CUTL_NO_REPORT, NULL);
+	fclose(report);
+	remove(path);
+}
+
+
+/** Reports of several formats.
+ */
+static void report_multiple_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char tap_path[L_tmpnam], json_path[L_tmpnam];
+	strcpy(tap_path, tmpnam(NULL));
+	strcpy(json_path, tmpnam(NULL));
+	char tap_arg[L_tmpnam + 8], json_arg[L_tmpnam + 8];
+	sprintf(tap_arg, "tap:%s", tap_path);
+	sprintf(json_arg, "json:%s", json_path);
+	char *argv[] = {"My_tests", "-R", tap_arg, "-R", json_arg};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(
+		cutl, cutl_get_report_format(fix->cutl), CUTL_TAP | CUTL_JSON
+	);
+	FILE *tap = cutl_get_report(fix->cutl, CUTL_TAP);
+	FILE *json = cutl_get_report(fix->cutl, CUTL_JSON);
+	cutl_assert(cutl, tap != NULL && json != NULL, "No report files.");
+
+	// Cleanup
+	cutl_set_report(fix->cutl, CUTL_NO_REPORT, NULL);
+	fclose(tap);
+	fclose(json);
+	remove(tap_path);
+	remove(json_path);
+}
+
+
+/** Unknown report format.
+ */
+static void report_bad_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-R", "xml:report.xml"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert(
+		cutl, cutl_get_report(fix->cutl, CUTL_JUNIT) == NULL,
+		"Report set."
+	);
+}
+
+
+
+// JOBS OPTION
+
+/** Set number of parallel jobs.
+ */
+static void jobs_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-j", "4"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_jobs(fix->cutl), 4);
+}
+
+
+/** Bad number of parallel jobs.
+ */
+static void jobs_bad_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-j", "0"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_jobs(fix->cutl), 1);
+}
+
+
+
+/** Isolate tests.
+ */
+static void isolated_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-i"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_true(cutl, cutl_get_isolated(fix->cutl));
+}
+
+
+// ASYNC OPTION
+
+/** Set asynchronous output.
+ */
+static void async_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-a"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_true(cutl, cutl_get_async(fix->cutl));
+}
+
+
+// SHARD OPTION
+
+/** Set shard.
+ */
+static void shard_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-S", "2/3"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	int count = 0;
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_shard(fix->cutl, &count), 2);
+	cutl_assert_equal(cutl, count, 3);
+}
+
+
+/** Bad shard.
+ */
+static void shard_bad_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-S", "4/3"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	int count = 0;
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_shard(fix->cutl, &count), 1);
+	cutl_assert_equal(cutl, count, 1);
+}
+
+
+
+// FILTER OPTIONS
+
+/** Patterns of tests to run or to skip.
+ */
+static void filter_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-f", "suite/*", "-F", "*/test", "-f", "a"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	bool is_excluded = true;
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	const char *pattern = cutl_get_filter(fix->cutl, 0, &is_excluded);
+	cutl_assert(cutl, strcmp(pattern, "suite/*") == 0, "Wrong pattern.");
+	cutl_assert_false(cutl, is_excluded);
+	pattern = cutl_get_filter(fix->cutl, 1, &is_excluded);
+	cutl_assert(cutl, strcmp(pattern, "*/test") == 0, "Wrong pattern.");
+	cutl_assert_true(cutl, is_excluded);
+	pattern = cutl_get_filter(fix->cutl, 2, &is_excluded);
+	cutl_assert(cutl, strcmp(pattern, "a") == 0, "Wrong pattern.");
+	cutl_assert_false(cutl, is_excluded);
+	cutl_assert(
+		cutl, cutl_get_filter(fix->cutl, 3, NULL) == NULL,
+		"Too many patterns."
+	);
+}
+
+
+/** Missing pattern.
+ */
+static void filter_missing_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-F"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert(
+		cutl, cutl_get_filter(fix->cutl, 0, NULL) == NULL,
+		"Pattern added."
+	);
+}
+
+
+/** Patterns are not added when a later option is invalid.
+ */
+static void filter_invalid_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-f", "suite/*", "-j", "0"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert(
+		cutl, cutl_get_filter(fix->cutl, 0, NULL) == NULL,
+		"Pattern added."
+	);
+}
+
+
+// TIMINGS OPTION
+
+/** Set timings file.
+ */
+static void timings_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-T", "my_timings.txt"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_true(cutl, cutl_get_timings(fix->cutl) == argv[2]);
+}
+
+
+/** Missing timings file.
+ */
+static void timings_missing_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-T"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_true(cutl, cutl_get_timings(fix->cutl) == NULL);
+}
+
+
+
+// CACHE OPTIONS
+
+/** Set results cache file.
+ */
+static void cache_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-C", "my_cache.txt"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_true(cutl, cutl_get_cache(fix->cutl) == argv[2]);
+	cutl_assert_false(cutl, cutl_get_failed_first(fix->cutl));
+}
+
+
+/** Run failed tests first, with results cached next to the program.
+ */
+static void failed_first_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-n"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_true(cutl, cutl_get_failed_first(fix->cutl));
+	const char *cache = cutl_get_cache(fix->cutl);
+	cutl_assert(
+		cutl, cache != NULL && strcmp(cache, "My_tests.cache") == 0,
+		"Wrong cache file '%s'.", cache ? cache : "(null)"
+	);
+}
+
+
+/** Skip unchanged tests, with results cached in the given file.
+ */
+static void incremental_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-u", "-C", "my_cache.txt"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_true(cutl, cutl_get_incremental(fix->cutl));
+	cutl_assert_true(cutl, cutl_get_cache(fix->cutl) == argv[3]);
+}
+
+
+
+// SLOWEST OPTION
+
+/** Set number of slowest tests.
+ */
+static void slowest_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-d", "5"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_slowest(fix->cutl), 5);
+}
+
+
+/** Bad number of slowest tests.
+ */
+static void slowest_bad_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-d", "few"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_slowest(fix->cutl), 0);
+}
+
+
+
+// TIMEOUT OPTION
+
+/** Set timeout.
+ */
+static void timeout_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-t", "1500"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_timeout(fix->cutl), 1500);
+}
+
+
+/** Set processor time limit.
+ */
+static void timeout_cpu_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-t", "500", "-t", "cpu:200"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_timeout(fix->cutl), 500);
+	cutl_assert_equal(cutl, cutl_get_cpu_timeout(fix->cutl), 200);
+}
+
+
+/** Bad processor time limit.
+ */
+static void timeout_cpu_bad_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-t", "cpu:"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_cpu_timeout(fix->cutl), 0);
+}
+
+
+/** Bad timeout.
+ */
+static void timeout_bad_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-t", "soon"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_timeout(fix->cutl), 0);
+}
+
+
+
+// GUARD OPTION
+
+/** Set crash guard.
+ */
+static void guard_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-g", "error"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_guard(fix->cutl), CUTL_ERROR);
+}
+
+
+/** Bad crash guard.
+ */
+static void guard_bad_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-g", "warn"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_guard(fix->cutl), 0);
+}
+
+
+
+// LEAKS OPTION
+
+/** Set leaks report.
+ */
+static void leaks_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-L", "warn"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_leaks(fix->cutl), CUTL_WARN);
+}
+
+
+/** Bad leaks report.
+ */
+static void leaks_bad_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-L", "info"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_leaks(fix->cutl), 0);
+}
+
+
+
+// BASELINE OPTIONS
+
+/** Set baseline file.
+ */
+static void baseline_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-b", "my_baseline.txt"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_true(cutl, cutl_get_baseline(fix->cutl) == argv[2]);
+}
+
+
+/** Set regression threshold.
+ */
+static void regression_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-r", "25"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_regression(fix->cutl), 25);
+}
+
+
+/** Bad regression threshold.
+ */
+static void regression_bad_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-r", "-5"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_true(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_equal(cutl, cutl_get_regression(fix->cutl), 10);
+}
+
+
+/** Enable event counters.
+ */
+static void counters_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-p"};
+
+	// Function under test
+	cutl_parse_args(fix->cutl, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_false(cutl, cutl_get_error(fix->cutl));
+	cutl_assert_true(cutl, cutl_get_counters(fix->cutl));
+}
+
+
+
 // HELP OPTION
 
 /** Display help message.
@@ -226,6 +848,25 @@ static void help_test(Cutl *cutl, Fixture *fix)
 		"  -s               Silent output.\n"
 		"  -c <auto|on|off> Colored output.\n"
 		"  -o <file>        Output file.\n"
+		"  -a               Asynchronous output.\n"
+		"  -R <fmt:file>    Report (junit|tap|json|bin).\n"
+		"  -j <jobs>        Number of parallel jobs.\n"
+		"  -i               Run each test in a job.\n"
+		"  -S <index/count> Shard of tests to run.\n"
+		"  -f <pattern>     Run matching tests.\n"
+		"  -F <pattern>     Skip matching tests.\n"
+		"  -T <file>        Timings file.\n"
+		"  -C <file>        Results cache file.\n"
+		"  -n               Run failed tests first.\n"
+		"  -u               Skip unchanged tests.\n"
+		"  -d <count>       Slowest tests to list.\n"
+		"  -t [cpu:]<ms>    Timeout of tests.\n"
+		"  -g <fail|error>  Guard against crashes.\n"
+		"  -L <level>       Report memory leaks.\n"
+		"  -b <file>        Benchmark baseline file.\n"
+		"  -r <percent>     Regression threshold.\n"
+		"  -p               Count benchmark events.\n"
+		"  -l               List tests and exit.\n"
 		"  -h               Print this message and exit.\n"
 		"CUTL version: "CUTL_VERSION"\n";
 	cutl_assert_content(cutl, fix->output, expected);
@@ -400,6 +1041,49 @@ void cutl_parse_args_suite(Cutl *cutl)
 	cutl_test(cutl, output_bad_test);
 	cutl_test(cutl, output_missing_test);
 
+	cutl_test(cutl, report_test);
+	cutl_test(cutl, report_tap_test);
+	cutl_test(cutl, report_multiple_test);
+	cutl_test(cutl, report_bad_test);
+
+	cutl_test(cutl, jobs_test);
+	cutl_test(cutl, jobs_bad_test);
+	cutl_test(cutl, isolated_test);
+	cutl_test(cutl, async_test);
+
+	cutl_test(cutl, shard_test);
+	cutl_test(cutl, shard_bad_test);
+
+	cutl_test(cutl, filter_test);
+	cutl_test(cutl, filter_missing_test);
+	cutl_test(cutl, filter_invalid_test);
+
+	cutl_test(cutl, timings_test);
+	cutl_test(cutl, timings_missing_test);
+
+	cutl_test(cutl, cache_test);
+	cutl_test(cutl, failed_first_test);
+	cutl_test(cutl, incremental_test);
+
+	cutl_test(cutl, slowest_test);
+	cutl_test(cutl, slowest_bad_test);
+
+	cutl_test(cutl, timeout_test);
+	cutl_test(cutl, timeout_cpu_test);
+	cutl_test(cutl, timeout_cpu_bad_test);
+	cutl_test(cutl, timeout_bad_test);
+
+	cutl_test(cutl, guard_test);
+	cutl_test(cutl, guard_bad_test);
+
+	cutl_test(cutl, leaks_test);
+	cutl_test(cutl, leaks_bad_test);
+
+	cutl_test(cutl, baseline_test);
+	cutl_test(cutl, regression_test);
+	cutl_test(cutl, regression_bad_test);
+	cutl_test(cutl, counters_test);
+
 	cutl_test(cutl, help_test);
 
 	cutl_test(cutl, unknown_test);
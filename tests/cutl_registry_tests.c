@@ -0,0 +1,295 @@
+#include "tests.h"
+
+#include <string.h>
+
+#define ARGC(argv) (sizeof(argv)/sizeof(*argv))
+
+#ifdef CUTL_USE_SECTIONS
+
+
+
+// MY TEST FUNCTIONS
+
+// Paths of the tests run, in order.
+static char My_order[256];
+
+static void My_record(Cutl *cutl)
+{
+	const char *suite = cutl_get_name(cutl_get_parent(cutl));
+	const char *name = cutl_get_name(cutl);
+	const size_t length = strlen(My_order);
+	snprintf(
+		My_order + length, sizeof(My_order) - length, "%s/%s\n",
+		suite, name
+	);
+}
+
+CUTL_TEST(My_suite, second) {
+	My_record(cutl);
+}
+
+CUTL_TEST(My_suite, first) {
+	My_record(cutl);
+	cutl_fail_at(cutl, NULL, 0, "My failure");
+}
+
+static void My_start(Cutl *cutl, void *data)
+{
+	static int value = 42;
+	cutl_set_data(cutl, &value);
+}
+
+CUTL_TEST(My_fixture_suite, data) {
+	My_record(cutl);
+	cutl_assert(cutl, data != NULL && *(int*) data == 42, "No data.");
+}
+
+CUTL_FIXTURE(My_fixture_suite, My_start, NULL)
+
+
+// Whether the cache file has the test with the given status.
+static bool My_has_result(FILE *file, const char *name, char status)
+{
+	char line[256];
+	rewind(file);
+	while (fgets(line, sizeof(line), file) != NULL) {
+		line[strcspn(line, "\n")] = '\0';
+		const char *space = strrchr(line, ' ');
+		if (space == NULL || strcmp(space + 1, name) != 0) continue;
+
+		char found;
+		return sscanf(line, "%*x %*f %c", &found) == 1
+			&& found == status;
+	}
+	return false;
+}
+
+
+// Lists the tests with the given arguments.
+static void My_list(
+	Cutl *cutl, Fixture *fix, int argc, char * const argv[])
+{
+	cutl_at_interrupt(fix->cutl, at_interrupt_longjmp, fix);
+	FILE * const old_stdout = stdout;
+	stdout = fix->output; // Tests are listed on stdout.
+
+	if (setjmp(fix->env) == 0) {
+		cutl_parse_args(fix->cutl, argc, argv);
+		stdout = old_stdout;
+		cutl_assert_canceled(cutl);
+	}
+	stdout = old_stdout;
+}
+
+
+
+// RUN REGISTERED
+
+/** Suites are run by name, tests in the order they are defined, with the
+ * fixture of their suite.
+ */
+static void run_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	My_order[0] = '\0';
+
+	// Function under test
+	int failed = cutl_run_registered(fix->cutl);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 2);
+	cutl_assert(
+		cutl, strcmp(
+			My_order, "My_fixture_suite/data\n"
+			"My_suite/second\nMy_suite/first\n"
+		) == 0, "Tests run in the wrong order:\n%s", My_order
+	);
+}
+
+
+
+// RESULTS CACHE
+
+/** Results of the tests are written in the cache by cutl_summary().
+ */
+static void cache_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+	cutl_set_cache(fix->cutl, path);
+	cutl_run_registered(fix->cutl);
+
+	// Function under test
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	FILE *file = fopen(path, "r");
+	cutl_assert(cutl, file != NULL, "No cache file.");
+	cutl_assert_true(cutl, My_has_result(file, "My_suite/first", 'F'));
+	cutl_assert_true(cutl, My_has_result(file, "My_suite/second", 'P'));
+	cutl_assert_true(
+		cutl, My_has_result(file, "My_fixture_suite/data", 'P')
+	);
+
+	// Cleanup
+	fclose(file);
+	remove(path);
+}
+
+
+/** Tests that failed last time are run first, with their suite.
+ */
+static void failed_first_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	Cutl *other = cutl_new(NULL);
+	cutl_set_verbosity(other, CUTL_SILENT);
+	cutl_set_cache(other, path);
+	cutl_run_registered(other);
+	cutl_summary(other);
+	cutl_free(other);
+
+	My_order[0] = '\0';
+	cutl_set_cache(fix->cutl, path);
+	cutl_set_failed_first(fix->cutl, true);
+
+	// Function under test
+	int failed = cutl_run_registered(fix->cutl);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 1);
+	cutl_assert(
+		cutl, strcmp(
+			My_order, "My_suite/first\nMy_suite/second\n"
+			"My_fixture_suite/data\n"
+		) == 0, "Tests run in the wrong order:\n%s", My_order
+	);
+
+	// Cleanup
+	remove(path);
+}
+
+
+/** Tests not in the cache are run after those that failed, and before
+ * those that passed.
+ */
+static void failed_first_new_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	Cutl *other = cutl_new(NULL);
+	cutl_set_verbosity(other, CUTL_SILENT);
+	cutl_set_cache(other, path);
+	cutl_add_filter(other, "My_suite/second", false);
+	cutl_run_registered(other);
+	cutl_summary(other);
+	cutl_free(other);
+
+	char *argv[] = {"My_tests", "-n", "-C", path, "-l"};
+
+	// Function under test
+	My_list(cutl, fix, ARGC(argv), argv);
+
+	// Asserts
+	const char *expected =
+		"My_fixture_suite/data\n"
+		"My_suite/first\n"
+		"My_suite/second\n";
+	cutl_assert_content(cutl, fix->output, expected);
+
+	// Cleanup
+	remove(path);
+}
+
+
+
+// LIST OPTION
+
+/** Registered tests are listed without being run.
+ */
+static void list_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	My_order[0] = '\0';
+	char *argv[] = {"My_tests", "-l"};
+
+	// Function under test
+	My_list(cutl, fix, ARGC(argv), argv);
+
+	// Asserts
+	const char *expected =
+		"My_fixture_suite/data\n"
+		"My_suite/second\n"
+		"My_suite/first\n";
+	cutl_assert_content(cutl, fix->output, expected);
+	cutl_assert_equal(cutl, My_order[0], '\0');
+	cutl_assert_equal(cutl, cutl_get_children(fix->cutl), 0);
+}
+
+
+/** Tests of the shard are listed, the same as those run.
+ */
+static void list_shard_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	Cutl *other = cutl_new(NULL);
+	cutl_set_verbosity(other, CUTL_SILENT);
+	cutl_set_shard(other, 1, 3);
+	My_order[0] = '\0';
+	cutl_run_registered(other);
+	cutl_free(other);
+	cutl_check(cutl, My_order[0] != '\0', "No test in the shard.");
+	char *argv[] = {"My_tests", "-S", "1/3", "-l"};
+
+	// Function under test
+	My_list(cutl, fix, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_content(cutl, fix->output, My_order);
+}
+
+
+
+/** Tests matching the patterns are listed.
+ */
+static void list_filter_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char *argv[] = {"My_tests", "-F", "*/second", "-f", "My_suite", "-l"};
+
+	// Function under test
+	My_list(cutl, fix, ARGC(argv), argv);
+
+	// Asserts
+	cutl_assert_content(cutl, fix->output, "My_suite/first\n");
+}
+
+
+// REGISTRY SUITE
+
+void cutl_registry_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, run_test);
+	cutl_test(cutl, cache_test);
+	cutl_test(cutl, failed_first_test);
+	cutl_test(cutl, failed_first_new_test);
+	cutl_test(cutl, list_test);
+	cutl_test(cutl, list_shard_test);
+	cutl_test(cutl, list_filter_test);
+}
+
+#else
+
+void cutl_registry_suite(Cutl *cutl) {}
+
+#endif
@@ -0,0 +1,746 @@
+#include "tests.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+
+// MY TEST FUNCTIONS
+
+static void My_pass_test(Cutl *cutl, void *data)
+{
+	cutl_assert_true(cutl, true);
+}
+
+static void My_fail_test(Cutl *cutl, void *data)
+{
+	cutl_message_at(cutl, CUTL_INFO, NULL, 0, "My message");
+	cutl_fail_at(cutl, "My_file.c", 12, "My failure");
+}
+
+static void My_suite(Cutl *cutl, void *data)
+{
+	cutl_run(cutl, "test1", My_pass_test, NULL);
+	cutl_run(cutl, "test2", My_fail_test, NULL);
+}
+
+static void My_nested_suite(Cutl *cutl, void *data)
+{
+	cutl_message_at(cutl, CUTL_WARN, NULL, 0, "My warning");
+	cutl_run(cutl, "subsuite", My_suite, NULL);
+	cutl_run(cutl, "test", My_pass_test, NULL);
+}
+
+static void My_escape_test(Cutl *cutl, void *data)
+{
+	cutl_message_at(cutl, CUTL_INFO, NULL, 0, "<\"a\" & 'b'>\n\001");
+}
+
+
+// Leaves out the values of the key, up to the `stop` character.
+static void My_strip(Cutl *cutl, char *content, const char *key, char stop)
+{
+	char *value = content;
+	while ((value = strstr(value, key)) != NULL) {
+		value += strlen(key);
+		char *end = strchr(value, stop);
+		cutl_assert(cutl, end != NULL, "Unterminated value.");
+		memmove(value, end, strlen(end) + 1);
+	}
+}
+
+
+// Reads the report, leaving out the durations that vary from run to run, and
+// the keys.
+static void My_read_report(
+	Cutl *cutl, FILE *report, char *content, size_t size)
+{
+	rewind(report);
+	content[fread(content, 1, size - 1, report)] = '\0';
+
+	My_strip(cutl, content, " time=\"", '"');
+	My_strip(cutl, content, "\"duration\":", ',');
+	My_strip(cutl, content, "\"cpu_duration\":", ',');
+	My_strip(cutl, content, "\"key\":", ',');
+}
+
+
+static void My_check_report(Cutl *cutl, FILE *report, const char *expected)
+{
+	char content[4096];
+	My_read_report(cutl, report, content, sizeof(content));
+
+	cutl_assert(
+		cutl, strcmp(content, expected) == 0,
+		"Report differs:\n%s", content
+	);
+}
+
+
+// Reads the binary log as a string of the types of its records, checking
+// that every string is written before it is referred to.
+static void My_read_log(
+	Cutl *cutl, FILE *report, char *types, size_t size,
+	Cutl_Log_Record *last)
+{
+	uint64_t ids[32] = {0};
+	size_t nb_ids = 0, nb_types = 0;
+
+	rewind(report);
+	Cutl_Log_Record record;
+	while (fread(&record, sizeof(record), 1, report) == 1) {
+		cutl_check(cutl, nb_types < size - 1, "Too many records.");
+		types[nb_types++] = '0' + record.type;
+		*last = record;
+
+		if (record.type == CUTL_LOG_BEGIN) {
+			cutl_assert_equal(cutl, record.name, CUTL_LOG_MAGIC);
+			cutl_assert_equal(cutl, record.size, sizeof(record));
+			continue;
+		}
+		if (record.type == CUTL_LOG_STRING) {
+			cutl_check(cutl, nb_ids < 32, "Too many strings.");
+			ids[nb_ids++] = record.name;
+			fseek(report, record.size, SEEK_CUR);
+			continue;
+		}
+
+		bool found = record.name == 0;
+		for (size_t i=0; i<nb_ids && !found; ++i) {
+			found = ids[i] == record.name;
+		}
+		cutl_assert(
+			cutl, found, "Unknown string: %llu.",
+			(unsigned long long) record.name
+		);
+	}
+	types[nb_types] = '\0';
+}
+
+
+static const char *My_expected =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<testsuites>\n"
+	"  <testsuite name=\"Unit tests\">\n"
+	"    <testsuite name=\"suite\">\n"
+	"      <testcase name=\"test1\" classname=\"suite\" time=\"\"/>\n"
+	"      <testcase name=\"test2\" classname=\"suite\" time=\"\">\n"
+	"        <failure type=\"FAIL\" message=\"My failure\">"
+	"My_file.c:12</failure>\n"
+	"        <system-out>[INFO] My message&#10;</system-out>\n"
+	"      </testcase>\n"
+	"    </testsuite>\n"
+	"    <testcase name=\"test\" classname=\"Unit tests\" time=\"\"/>\n"
+	"  </testsuite>\n"
+	"</testsuites>\n";
+
+
+static const char *My_tap_expected =
+	"TAP version 14\n"
+	"    # Subtest: suite\n"
+	"    ok - test1\n"
+	"    not ok - test2\n"
+	"      ---\n"
+	"      messages:\n"
+	"        - severity: info\n"
+	"          message: \"My message\"\n"
+	"        - severity: fail\n"
+	"          message: \"My failure\"\n"
+	"          at:\n"
+	"            file: \"My_file.c\"\n"
+	"            line: 12\n"
+	"      ...\n"
+	"    1..2\n"
+	"not ok - suite\n"
+	"ok - test\n"
+	"1..2\n";
+
+
+static const char *My_json_expected =
+	"{\"event\":\"test_start\",\"id\":1,\"parent\":0,\"key\":,"
+	"\"depth\":1,\"path\":[\"suite\"]}\n"
+	"{\"event\":\"test_start\",\"id\":2,\"parent\":1,\"key\":,"
+	"\"depth\":2,\"path\":[\"suite\",\"test1\"]}\n"
+	"{\"event\":\"test_end\",\"id\":2,\"parent\":1,\"key\":,"
+	"\"depth\":2,\"path\":[\"suite\",\"test1\"],\"suite\":false,"
+	"\"duration\":,\"cpu_duration\":,\"status\":\"passed\"}\n"
+	"{\"event\":\"test_start\",\"id\":3,\"parent\":1,\"key\":,"
+	"\"depth\":2,\"path\":[\"suite\",\"test2\"]}\n"
+	"{\"event\":\"message\",\"id\":3,\"parent\":1,\"key\":,"
+	"\"depth\":2,\"path\":[\"suite\",\"test2\"],\"severity\":\"info\","
+	"\"file\":null,\"line\":null,\"text\":\"My message\"}\n"
+	"{\"event\":\"message\",\"id\":3,\"parent\":1,\"key\":,"
+	"\"depth\":2,\"path\":[\"suite\",\"test2\"],\"severity\":\"fail\","
+	"\"file\":\"My_file.c\",\"line\":12,\"text\":\"My failure\"}\n"
+	"{\"event\":\"test_end\",\"id\":3,\"parent\":1,\"key\":,"
+	"\"depth\":2,\"path\":[\"suite\",\"test2\"],\"suite\":false,"
+	"\"duration\":,\"cpu_duration\":,\"status\":\"failed\"}\n"
+	"{\"event\":\"test_end\",\"id\":1,\"parent\":0,\"key\":,"
+	"\"depth\":1,\"path\":[\"suite\"],\"suite\":true,\"duration\":,"
+	"\"cpu_duration\":,\"status\":\"failed\",\"passed\":1,"
+	"\"failed\":1,\"skipped\":0}\n"
+	"{\"event\":\"test_start\",\"id\":4,\"parent\":0,\"key\":,"
+	"\"depth\":1,\"path\":[\"test\"]}\n"
+	"{\"event\":\"test_end\",\"id\":4,\"parent\":0,\"key\":,"
+	"\"depth\":1,\"path\":[\"test\"],\"suite\":false,\"duration\":,"
+	"\"cpu_duration\":,\"status\":\"passed\"}\n"
+	"{\"event\":\"summary\",\"id\":0,\"parent\":null,\"key\":,"
+	"\"depth\":0,\"path\":[],\"status\":\"failed\",\"passed\":2,"
+	"\"failed\":1,\"skipped\":0}\n";
+
+
+
+/** No report is written by default.
+ */
+static void default_test(Cutl *cutl, Fixture *fix)
+{
+	// Asserts
+	cutl_assert(
+		cutl, cutl_get_report(fix->cutl, CUTL_JUNIT) == NULL,
+		"Report set."
+	);
+	cutl_assert_equal(cutl, cutl_get_report_format(fix->cutl), 0);
+}
+
+
+/** Suites and tests are reported as they end, completed by the summary.
+ */
+static void junit_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_JUNIT, report);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	cutl_assert(
+		cutl, cutl_get_report(fix->cutl, CUTL_JUNIT) == NULL,
+		"Not done."
+	);
+	My_check_report(cutl, report, My_expected);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Messages of suites are written when they are closed.
+ */
+static void nested_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_JUNIT, report);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_nested_suite, NULL);
+	cutl_message_at(fix->cutl, CUTL_INFO, NULL, 0, "Root message");
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	const char *expected =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<testsuites>\n"
+		"  <testsuite name=\"Unit tests\">\n"
+		"    <testsuite name=\"suite\">\n"
+		"      <testsuite name=\"subsuite\">\n"
+		"        <testcase name=\"test1\" classname=\"suite.subsuite\""
+		" time=\"\"/>\n"
+		"        <testcase name=\"test2\" classname=\"suite.subsuite\""
+		" time=\"\">\n"
+		"          <failure type=\"FAIL\" message=\"My failure\">"
+		"My_file.c:12</failure>\n"
+		"          <system-out>[INFO] My message&#10;</system-out>\n"
+		"        </testcase>\n"
+		"      </testsuite>\n"
+		"      <testcase name=\"test\" classname=\"suite\""
+		" time=\"\"/>\n"
+		"      <system-out>[WARN] My warning&#10;</system-out>\n"
+		"    </testsuite>\n"
+		"    <system-out>[INFO] Root message&#10;</system-out>\n"
+		"  </testsuite>\n"
+		"</testsuites>\n";
+	My_check_report(cutl, report, expected);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Names and messages are escaped.
+ */
+static void escape_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_JUNIT, report);
+
+	// Function under test
+	cutl_run(fix->cutl, "a<b>&\"c\"", My_escape_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	const char *expected =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<testsuites>\n"
+		"  <testsuite name=\"Unit tests\">\n"
+		"    <testcase name=\"a&lt;b&gt;&amp;&quot;c&quot;\""
+		" classname=\"Unit tests\" time=\"\">\n"
+		"      <system-out>[INFO] &lt;&quot;a&quot; &amp; 'b'&gt;&#10;?"
+		"&#10;</system-out>\n"
+		"    </testcase>\n"
+		"  </testsuite>\n"
+		"</testsuites>\n";
+	My_check_report(cutl, report, expected);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Reports are completed when the test context is freed.
+ */
+static void free_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	Cutl *other = cutl_new(NULL);
+	cutl_check(cutl, other != NULL, "Could not create test context.");
+	cutl_set_verbosity(other, CUTL_SILENT);
+	cutl_set_report(other, CUTL_JUNIT, report);
+	cutl_run(other, "test", My_pass_test, NULL);
+
+	// Function under test
+	cutl_free(other);
+
+	// Asserts
+	const char *expected =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<testsuites>\n"
+		"  <testsuite name=\"Unit tests\">\n"
+		"    <testcase name=\"test\" classname=\"Unit tests\""
+		" time=\"\"/>\n"
+		"  </testsuite>\n"
+		"</testsuites>\n";
+	My_check_report(cutl, report, expected);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Tests are written as TAP test points, suites as subtests.
+ */
+static void tap_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_TAP, report);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	cutl_assert(
+		cutl, cutl_get_report(fix->cutl, CUTL_TAP) == NULL,
+		"Not done."
+	);
+	My_check_report(cutl, report, My_tap_expected);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Messages of suites go in the YAML block of the suite, those of the root
+ * are comments.
+ */
+static void tap_nested_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_TAP, report);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_nested_suite, NULL);
+	cutl_message_at(fix->cutl, CUTL_INFO, NULL, 0, "Root message");
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	const char *expected =
+		"TAP version 14\n"
+		"    # Subtest: suite\n"
+		"        # Subtest: subsuite\n"
+		"        ok - test1\n"
+		"        not ok - test2\n"
+		"          ---\n"
+		"          messages:\n"
+		"            - severity: info\n"
+		"              message: \"My message\"\n"
+		"            - severity: fail\n"
+		"              message: \"My failure\"\n"
+		"              at:\n"
+		"                file: \"My_file.c\"\n"
+		"                line: 12\n"
+		"          ...\n"
+		"        1..2\n"
+		"    not ok - subsuite\n"
+		"    ok - test\n"
+		"    1..2\n"
+		"not ok - suite\n"
+		"  ---\n"
+		"  messages:\n"
+		"    - severity: warn\n"
+		"      message: \"My warning\"\n"
+		"  ...\n"
+		"# [INFO] Root message\n"
+		"1..1\n";
+	My_check_report(cutl, report, expected);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Directives in names and special characters in messages are escaped.
+ */
+static void tap_escape_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_TAP, report);
+
+	// Function under test
+	cutl_run(fix->cutl, "a # SKIP\\", My_escape_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	const char *expected =
+		"TAP version 14\n"
+		"ok - a \\# SKIP\\\\\n"
+		"  ---\n"
+		"  messages:\n"
+		"    - severity: info\n"
+		"      message: \"<\\\"a\\\" & 'b'>\\n\\x01\"\n"
+		"  ...\n"
+		"1..1\n";
+	My_check_report(cutl, report, expected);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Events are streamed as JSON Lines.
+ */
+static void json_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_JSON, report);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	My_check_report(cutl, report, My_json_expected);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Messages are written as they are printed, and escaped.
+ */
+static void json_escape_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_JSON, report);
+
+	// Function under test
+	cutl_message_at(fix->cutl, CUTL_WARN, "a\\b.c", 3, "<\"a\">\n\001");
+
+	// Asserts
+	const char *expected =
+		"{\"event\":\"message\",\"id\":0,\"parent\":null,\"key\":,"
+		"\"depth\":0,\"path\":[],\"severity\":\"warn\","
+		"\"file\":\"a\\\\b.c\",\"line\":3,"
+		"\"text\":\"<\\\"a\\\">\\n\\u0001\"}\n";
+	My_check_report(cutl, report, expected);
+
+	// Cleanup
+	cutl_set_report(fix->cutl, CUTL_NO_REPORT, NULL);
+	fclose(report);
+}
+
+
+/** Reports of several formats are written at the same time.
+ */
+static void multiple_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *junit = tmpfile();
+	FILE *tap = tmpfile();
+	FILE *json = tmpfile();
+	cutl_check(cutl, junit && tap && json, "Could not make tmp files.");
+	cutl_set_report(fix->cutl, CUTL_JUNIT, junit);
+	cutl_set_report(fix->cutl, CUTL_TAP, tap);
+	cutl_set_report(fix->cutl, CUTL_JSON, json);
+	cutl_assert_equal(
+		cutl, cutl_get_report_format(fix->cutl),
+		CUTL_JUNIT | CUTL_TAP | CUTL_JSON
+	);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_report_format(fix->cutl), 0);
+	My_check_report(cutl, junit, My_expected);
+	My_check_report(cutl, tap, My_tap_expected);
+	My_check_report(cutl, json, My_json_expected);
+
+	// Cleanup
+	fclose(junit);
+	fclose(tap);
+	fclose(json);
+}
+
+
+/** Reports of workers are replayed in order.
+ */
+static void jobs_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_JUNIT, report);
+	cutl_set_jobs(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	My_check_report(cutl, report, My_expected);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Reports of tests run on threads are replayed in order.
+ */
+static void parallel_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_JUNIT, report);
+	cutl_set_parallel(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	My_check_report(cutl, report, My_expected);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Events of workers and threads are replayed when they are joined, along
+ * with the other reports.
+ */
+static void json_jobs_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *tap = tmpfile();
+	FILE *json = tmpfile();
+	cutl_check(cutl, tap && json, "Could not make tmp files.");
+	cutl_set_report(fix->cutl, CUTL_TAP, tap);
+	cutl_set_report(fix->cutl, CUTL_JSON, json);
+	cutl_set_jobs(fix->cutl, 2);
+	cutl_set_parallel(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	My_check_report(cutl, tap, My_tap_expected);
+
+	// Ids are only unique within jobs.
+	char content[4096];
+	My_read_report(cutl, json, content, sizeof(content));
+	My_strip(cutl, content, "\"id\":", ',');
+	My_strip(cutl, content, "\"parent\":", ',');
+	char expected[4096];
+	strcpy(expected, My_json_expected);
+	My_strip(cutl, expected, "\"id\":", ',');
+	My_strip(cutl, expected, "\"parent\":", ',');
+	cutl_assert(
+		cutl, strcmp(content, expected) == 0,
+		"Report differs:\n%s", content
+	);
+
+	// Cleanup
+	fclose(tap);
+	fclose(json);
+}
+
+
+/** TAP plans count the tests of workers and threads once they are joined.
+ */
+static void tap_jobs_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_TAP, report);
+	cutl_set_jobs(fix->cutl, 2);
+	cutl_set_parallel(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	My_check_report(cutl, report, My_tap_expected);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Events are logged as binary records, with each string written once.
+ */
+static void binary_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_BINARY, report);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	char types[64];
+	Cutl_Log_Record last;
+	My_read_log(cutl, report, types, sizeof(types), &last);
+	cutl_assert(
+		cutl, strcmp(types, "123235232422455235356") == 0,
+		"Records differ: %s", types
+	);
+	cutl_assert_equal(cutl, last.status, CUTL_LOG_FAILED);
+	cutl_assert_equal(cutl, last.passed, 3);
+	cutl_assert_equal(cutl, last.failed, 1);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+/** Records of workers and threads are replayed when they are joined, with
+ * strings written again for each job.
+ */
+static void binary_jobs_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	FILE *report = tmpfile();
+	cutl_check(cutl, report != NULL, "Could not make tmp file.");
+	cutl_set_report(fix->cutl, CUTL_BINARY, report);
+	cutl_set_jobs(fix->cutl, 2);
+	cutl_set_parallel(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	char types[64];
+	Cutl_Log_Record last;
+	My_read_log(cutl, report, types, sizeof(types), &last);
+	char *end = types;
+	for (const char *type = types; *type != '\0'; ++type) {
+		if (*type != '0' + CUTL_LOG_STRING) *end++ = *type;
+	}
+	*end = '\0';
+	cutl_assert(
+		cutl, strcmp(types, "133534455356") == 0,
+		"Records differ: %s", types
+	);
+	cutl_assert_equal(cutl, last.passed, 2);
+	cutl_assert_equal(cutl, last.failed, 1);
+
+	// Cleanup
+	fclose(report);
+}
+
+
+
+// REPORT SUITE
+
+void cutl_report_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, default_test);
+	cutl_test(cutl, junit_test);
+	cutl_test(cutl, nested_test);
+	cutl_test(cutl, escape_test);
+	cutl_test(cutl, free_test);
+	cutl_test(cutl, tap_test);
+	cutl_test(cutl, tap_nested_test);
+	cutl_test(cutl, tap_escape_test);
+	cutl_test(cutl, json_test);
+	cutl_test(cutl, json_escape_test);
+	cutl_test(cutl, multiple_test);
+	cutl_test(cutl, binary_test);
+
+#ifdef CUTL_USE_FORK
+	cutl_test(cutl, jobs_test);
+#endif
+
+#ifdef CUTL_USE_PTHREAD
+	cutl_test(cutl, parallel_test);
+#endif
+
+#if defined(CUTL_USE_FORK) || defined(CUTL_USE_PTHREAD)
+	cutl_test(cutl, tap_jobs_test);
+	cutl_test(cutl, json_jobs_test);
+	cutl_test(cutl, binary_jobs_test);
+#endif
+}
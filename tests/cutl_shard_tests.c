@@ -0,0 +1,173 @@
+#include "tests.h"
+
+
+
+// MY TEST FUNCTIONS
+
+enum { NB_TESTS = 8, NB_SHARDS = 3 };
+
+static const char * const My_names[NB_TESTS] = {
+	"test1", "test2", "test3", "test4", "test5", "test6", "test7", "test8"
+};
+
+static void My_count_test(Cutl *cutl, void *data)
+{
+	int *count = data;
+	(*count)++;
+}
+
+static void My_count_suite(Cutl *cutl, void *data)
+{
+	int *counts = data;
+	for (int i=0; i<NB_TESTS; ++i) {
+		cutl_run(cutl, My_names[i], My_count_test, &counts[i]);
+	}
+}
+
+static void My_shard_test(Cutl *cutl, void *data)
+{
+	int *count = data;
+	cutl_get_shard(cutl, count);
+}
+
+static void My_shard_suite(Cutl *cutl, void *data)
+{
+	int *counts = data;
+	cutl_run(cutl, "test", My_shard_test, &counts[0]);
+	cutl_run(cutl, "test", My_shard_test, &counts[1]);
+}
+
+
+
+/** Each test is run in exactly one shard.
+ */
+static void partition_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int counts[NB_TESTS] = {0};
+
+	// Function under test
+	for (int i=1; i<=NB_SHARDS; ++i) {
+		cutl_set_shard(fix->cutl, i, NB_SHARDS);
+		cutl_run_as_suite(fix->cutl, "suite", My_count_suite, counts);
+	}
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), NB_TESTS);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 0);
+	for (int i=0; i<NB_TESTS; ++i) {
+		cutl_assert(
+			cutl, counts[i] == 1, "Test %d run %d times.", i,
+			counts[i]
+		);
+	}
+}
+
+
+/** Shards only depend on the names of the tests.
+ */
+static void stable_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int counts[NB_TESTS] = {0};
+	int other = 0;
+	cutl_set_shard(fix->cutl, 2, NB_SHARDS);
+
+	// Function under test
+	cutl_run_as_suite(fix->cutl, "suite", My_count_suite, counts);
+	cutl_run(fix->cutl, "other", My_count_test, &other);
+	cutl_run_as_suite(fix->cutl, "suite", My_count_suite, counts);
+
+	// Asserts
+	for (int i=0; i<NB_TESTS; ++i) {
+		cutl_assert(
+			cutl, counts[i] == 0 || counts[i] == 2,
+			"Test %d run %d times.", i, counts[i]
+		);
+	}
+}
+
+
+/** Tests of the shard are run whole.
+ */
+static void whole_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int counts[2] = {0};
+
+	// Function under test
+	for (int i=1; i<=2; ++i) {
+		cutl_set_shard(fix->cutl, i, 2);
+		cutl_run(fix->cutl, "suite1", My_shard_suite, counts);
+		cutl_run(fix->cutl, "suite2", My_shard_suite, counts);
+		cutl_run(fix->cutl, "suite3", My_shard_suite, counts);
+	}
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 6);
+	cutl_assert_equal(cutl, counts[0], 1);
+	cutl_assert_equal(cutl, counts[1], 1);
+}
+
+
+/** Summary of a shard.
+ */
+static void summary_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int counts[NB_TESTS] = {0};
+	cutl_set_verbosity(fix->cutl, CUTL_SUMMARY);
+	cutl_set_shard(fix->cutl, 3, NB_SHARDS);
+	cutl_run_as_suite(fix->cutl, "suite", My_count_suite, counts);
+
+	// Function under test
+	int failed = cutl_summary(fix->cutl);
+
+	// Asserts
+	int nb_run = 0;
+	for (int i=0; i<NB_TESTS; ++i) {
+		nb_run += counts[i];
+	}
+
+	char expected[128];
+	sprintf(
+		expected, "Unit tests (shard 3/3) summary: 0 failed, "
+		"%d passed.\n", nb_run
+	);
+	cutl_assert_content(cutl, fix->output, expected);
+	cutl_assert_equal(cutl, failed, 0);
+}
+
+
+/** Sharding is disabled by default.
+ */
+static void disabled_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int counts[NB_TESTS] = {0};
+	int count = 0;
+
+	// Function under test
+	cutl_run_as_suite(fix->cutl, "suite", My_count_suite, counts);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), NB_TESTS);
+	cutl_assert_equal(cutl, cutl_get_shard(fix->cutl, &count), 1);
+	cutl_assert_equal(cutl, count, 1);
+}
+
+
+
+// SHARD SUITE
+
+void cutl_shard_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, partition_test);
+	cutl_test(cutl, stable_test);
+	cutl_test(cutl, whole_test);
+	cutl_test(cutl, summary_test);
+	cutl_test(cutl, disabled_test);
+}
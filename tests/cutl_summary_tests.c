@@ -1,5 +1,8 @@
 #include "tests.h"
 
+#include <stdio.h>
+#include <time.h>
+
 
 // MY PASS TEST
 
@@ -246,6 +249,84 @@ static void canceled_toplevel_test(Cutl *cutl, Fixture *fix)
 
 
 
+// MY SLOW TESTS
+
+static void My_spin_test(Cutl *cutl, void *data)
+{
+	const int *delay = data;
+	const clock_t start = clock();
+	while (clock() - start < *delay * (CLOCKS_PER_SEC / 1000));
+}
+
+static const int My_delays[] = {0, 40, 20};
+
+static void My_slow_suite(Cutl *cutl, void *unused)
+{
+	cutl_run(cutl, "fast", My_spin_test, (void*) &My_delays[0]);
+	cutl_run(cutl, "slow", My_spin_test, (void*) &My_delays[1]);
+	cutl_run(cutl, "medium", My_spin_test, (void*) &My_delays[2]);
+}
+
+
+
+/** Slowest tests listed by the summary.
+ */
+static void slowest_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_verbosity(fix->cutl, CUTL_SUMMARY);
+	cutl_set_slowest(fix->cutl, 2);
+	cutl_run(fix->cutl, "suite", My_slow_suite, NULL);
+
+	// Function under test
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	double slow, medium;
+	rewind(fix->output);
+	const int nb_fields = fscanf(
+		fix->output,
+		"Unit tests summary: 0 failed, 3 passed.\n"
+		"Slowest tests:\n"
+		"	%lf ms suite/slow\n"
+		"	%lf ms suite/medium\n",
+		&slow, &medium
+	);
+	cutl_assert_equal(cutl, nb_fields, 2);
+	cutl_assert(cutl, medium >= 20.0, "Medium took %f ms.", medium);
+
+	char expected[256];
+	sprintf(
+		expected,
+		"Unit tests summary: 0 failed, 3 passed.\n"
+		"Slowest tests:\n"
+		"	%.3f ms suite/slow\n"
+		"	%.3f ms suite/medium\n",
+		slow, medium
+	);
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+/** Slowest tests are not listed by default.
+ */
+static void slowest_default_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_verbosity(fix->cutl, CUTL_SUMMARY);
+	cutl_run(fix->cutl, "suite", My_pass_suite, NULL);
+
+	// Function under test
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_slowest(fix->cutl), 0);
+	const char *expected = "Unit tests summary: 0 failed, 4 passed.\n";
+	cutl_assert_content(cutl, fix->output, expected);
+}
+
+
+
 // SUMMARY SUITE
 
 void cutl_summary_suite(Cutl *cutl)
@@ -265,4 +346,7 @@ void cutl_summary_suite(Cutl *cutl)
 	cutl_test(cutl, canceled_silent_test);
 	cutl_test(cutl, canceled_toplevel_test);
 
+	cutl_test(cutl, slowest_test);
+	cutl_test(cutl, slowest_default_test);
+
 }
@@ -8,6 +8,20 @@ extern void cutl_message_suite(Cutl *cutl);
 extern void cutl_run_suite(Cutl *cutl);
 extern void cutl_summary_suite(Cutl *cutl);
 extern void cutl_get_suite(Cutl *cutl);
+extern void cutl_jobs_suite(Cutl *cutl);
+extern void cutl_parallel_suite(Cutl *cutl);
+extern void cutl_shard_suite(Cutl *cutl);
+extern void cutl_timings_suite(Cutl *cutl);
+extern void cutl_timeout_suite(Cutl *cutl);
+extern void cutl_guard_suite(Cutl *cutl);
+extern void cutl_bench_suite(Cutl *cutl);
+extern void cutl_leaks_suite(Cutl *cutl);
+extern void cutl_alloc_suite(Cutl *cutl);
+extern void cutl_async_suite(Cutl *cutl);
+extern void cutl_report_suite(Cutl *cutl);
+extern void cutl_registry_suite(Cutl *cutl);
+extern void cutl_filter_suite(Cutl *cutl);
+extern void cutl_incremental_suite(Cutl *cutl);
 
 int main(int argc, char *argv[])
 {
@@ -21,6 +35,20 @@ int main(int argc, char *argv[])
 	cutl_suite(cutl, cutl_run_suite);
 	cutl_suite(cutl, cutl_summary_suite);
 	cutl_suite(cutl, cutl_get_suite);
+	cutl_suite(cutl, cutl_jobs_suite);
+	cutl_suite(cutl, cutl_parallel_suite);
+	cutl_suite(cutl, cutl_shard_suite);
+	cutl_suite(cutl, cutl_timings_suite);
+	cutl_suite(cutl, cutl_timeout_suite);
+	cutl_suite(cutl, cutl_guard_suite);
+	cutl_suite(cutl, cutl_bench_suite);
+	cutl_suite(cutl, cutl_leaks_suite);
+	cutl_suite(cutl, cutl_alloc_suite);
+	cutl_suite(cutl, cutl_async_suite);
+	cutl_suite(cutl, cutl_report_suite);
+	cutl_suite(cutl, cutl_registry_suite);
+	cutl_suite(cutl, cutl_filter_suite);
+	cutl_suite(cutl, cutl_incremental_suite);
 
 	int failed = cutl_summary(cutl);
 	cutl_free(cutl);
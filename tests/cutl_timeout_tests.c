@@ -0,0 +1,374 @@
+// Signal masks are POSIX.
+#define _POSIX_C_SOURCE 200809L
+
+#include "tests.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+
+// MY TEST FUNCTIONS
+
+enum { MY_TIMEOUT = 50 };
+
+static void My_pass_test(Cutl *cutl, void *data)
+{
+	cutl_assert_true(cutl, true);
+}
+
+// Loops until interrupted, for a bounded time.
+static void My_loop_test(Cutl *cutl, void *data)
+{
+	time_t start = time(NULL);
+	while (time(NULL) - start < 5);
+	cutl_fail_at(cutl, NULL, 0, "Not interrupted.");
+}
+
+// Sleeps for the given milliseconds, without using the processor.
+static void My_sleep_test(Cutl *cutl, void *data)
+{
+	const int *ms = data;
+	struct timespec time = {
+		.tv_sec = *ms / 1000, .tv_nsec = *ms % 1000 * 1000000L
+	};
+	while (nanosleep(&time, &time) != 0);
+}
+
+// Sets its own timeout, then loops.
+static void My_own_loop_test(Cutl *cutl, void *data)
+{
+	cutl_set_timeout(cutl, MY_TIMEOUT);
+	My_loop_test(cutl, data);
+}
+
+// Sets its own longer timeout, then sleeps.
+static void My_own_sleep_test(Cutl *cutl, void *data)
+{
+	cutl_set_timeout(cutl, 10000);
+	My_sleep_test(cutl, data);
+}
+
+static void My_loop_suite(Cutl *cutl, void *data)
+{
+	cutl_run(cutl, "test", My_loop_test, NULL);
+	cutl_run(cutl, "other", My_pass_test, NULL);
+}
+
+// Loops without letting the watchdog interrupt it.
+static void My_blocked_test(Cutl *cutl, void *data)
+{
+	sigset_t set;
+	sigemptyset(&set);
+	sigaddset(&set, SIGALRM);
+	sigprocmask(SIG_BLOCK, &set, NULL);
+	My_loop_test(cutl, data);
+}
+
+
+// Checks the output, where the elapsed time is formatted with "%.3f".
+static void My_check_timeout(Cutl *cutl, FILE *output, const char *format)
+{
+	char content[256] = "";
+	rewind(output);
+	content[fread(content, 1, sizeof(content) - 1, output)] = '\0';
+
+	const char *after = strstr(content, "Timed out after ");
+	cutl_assert(cutl, after != NULL, "Timeout not reported.");
+	const double elapsed = strtod(after + strlen("Timed out after "), NULL);
+	cutl_assert(
+		cutl, elapsed >= MY_TIMEOUT / 1000.0, "Timed out after %f s.",
+		elapsed
+	);
+
+	char expected[256];
+	sprintf(expected, format, elapsed);
+	cutl_assert_content(cutl, output, expected);
+}
+
+
+
+/** Tests running for too long are interrupted.
+ */
+static void interrupt_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_timeout(fix->cutl, MY_TIMEOUT);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_loop_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+	My_check_timeout(
+		cutl, fix->output,
+		"test:\n"
+		"	[FAIL] Timed out after %.3f s.\n"
+		"test failed.\n"
+	);
+}
+
+
+/** Children share the time of their parent, the rest of which is canceled.
+ */
+static void nested_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_timeout(fix->cutl, MY_TIMEOUT);
+
+	// Function under test
+	cutl_run(fix->cutl, "suite", My_loop_suite, NULL);
+	cutl_run(fix->cutl, "test", My_pass_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+	My_check_timeout(
+		cutl, fix->output,
+		"suite:\n"
+		"	test:\n"
+		"		[FAIL] Timed out after %.3f s.\n"
+		"	test failed.\n"
+		"suite failed.\n"
+	);
+}
+
+
+/** Tests run on threads are interrupted.
+ */
+static void parallel_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_timeout(fix->cutl, MY_TIMEOUT);
+	cutl_set_parallel(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_loop_test, NULL);
+	cutl_run(fix->cutl, "other", My_pass_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+	My_check_timeout(
+		cutl, fix->output,
+		"test:\n"
+		"	[FAIL] Timed out after %.3f s.\n"
+		"test failed.\n"
+	);
+}
+
+
+/** Tests run by workers are interrupted.
+ */
+static void jobs_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_timeout(fix->cutl, MY_TIMEOUT);
+	cutl_set_jobs(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_loop_test, NULL);
+	cutl_run(fix->cutl, "other", My_pass_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 1);
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+	My_check_timeout(
+		cutl, fix->output,
+		"test:\n"
+		"	[FAIL] Timed out after %.3f s.\n"
+		"test failed.\n"
+	);
+}
+
+
+/** Workers that can't be interrupted are killed.
+ */
+static void kill_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_timeout(fix->cutl, MY_TIMEOUT);
+	cutl_set_jobs(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_blocked_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+	My_check_timeout(
+		cutl, fix->output,
+		"test:\n"
+		"	[FAIL] Timed out after %.3f s.\n"
+		"test failed.\n"
+	);
+}
+
+
+/** Tests using too much processor time are interrupted.
+ */
+static void cpu_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_cpu_timeout(fix->cutl, MY_TIMEOUT);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_loop_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 1);
+	My_check_timeout(
+		cutl, fix->output,
+		"test:\n"
+		"	[FAIL] Timed out after %.3f s (CPU).\n"
+		"test failed.\n"
+	);
+}
+
+
+/** Sleeping tests use no processor time.
+ */
+static void cpu_sleep_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int ms = 4 * MY_TIMEOUT;
+	cutl_set_cpu_timeout(fix->cutl, MY_TIMEOUT);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_sleep_test, &ms);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+	cutl_assert_content(cutl, fix->output, "");
+}
+
+
+/** Sleeping tests still run out of time.
+ */
+static void sleep_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int ms = 5000;
+	cutl_set_timeout(fix->cutl, MY_TIMEOUT);
+	cutl_set_cpu_timeout(fix->cutl, MY_TIMEOUT);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_sleep_test, &ms);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 1);
+	My_check_timeout(
+		cutl, fix->output,
+		"test:\n"
+		"	[FAIL] Timed out after %.3f s.\n"
+		"test failed.\n"
+	);
+}
+
+
+/** Tests can set their own timeout.
+ */
+static void own_test(Cutl *cutl, Fixture *fix)
+{
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_own_loop_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 1);
+	cutl_assert_equal(cutl, cutl_get_timeout(fix->cutl), 0);
+	My_check_timeout(
+		cutl, fix->output,
+		"test:\n"
+		"	[FAIL] Timed out after %.3f s.\n"
+		"test failed.\n"
+	);
+}
+
+
+/** Tests can extend their own timeout.
+ */
+static void own_longer_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	int ms = 4 * MY_TIMEOUT;
+	cutl_set_timeout(fix->cutl, MY_TIMEOUT);
+
+	// Function under test
+	int failed = cutl_run(fix->cutl, "test", My_own_sleep_test, &ms);
+
+	// Asserts
+	cutl_assert_equal(cutl, failed, 0);
+	cutl_assert_content(cutl, fix->output, "");
+}
+
+
+/** Workers using too much processor time are killed.
+ */
+static void cpu_kill_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_cpu_timeout(fix->cutl, MY_TIMEOUT);
+	cutl_set_jobs(fix->cutl, 2);
+
+	// Function under test
+	cutl_run(fix->cutl, "test", My_blocked_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_failed(fix->cutl), 1);
+	My_check_timeout(
+		cutl, fix->output,
+		"test:\n"
+		"	[FAIL] Timed out after %.3f s (CPU).\n"
+		"test failed.\n"
+	);
+}
+
+
+/** Timeout only applies to the tests run while it is set.
+ */
+static void override_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+
+	// Function under test
+	cutl_set_timeout(fix->cutl, 10000);
+	cutl_run(fix->cutl, "test1", My_pass_test, NULL);
+	cutl_set_timeout(fix->cutl, 0);
+	cutl_run(fix->cutl, "test2", My_pass_test, NULL);
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), 2);
+	cutl_assert_equal(cutl, cutl_get_timeout(fix->cutl), 0);
+}
+
+
+
+// TIMEOUT SUITE
+
+void cutl_timeout_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, override_test);
+
+#ifdef CUTL_TIMEOUT_ENABLED
+	cutl_test(cutl, interrupt_test);
+	cutl_test(cutl, nested_test);
+	cutl_test(cutl, parallel_test);
+	cutl_test(cutl, cpu_test);
+	cutl_test(cutl, cpu_sleep_test);
+	cutl_test(cutl, sleep_test);
+	cutl_test(cutl, own_test);
+	cutl_test(cutl, own_longer_test);
+#endif
+
+#if defined(CUTL_TIMEOUT_ENABLED) && defined(CUTL_USE_FORK)
+	cutl_test(cutl, jobs_test);
+	cutl_test(cutl, kill_test);
+	cutl_test(cutl, cpu_kill_test);
+#endif
+}
@@ -0,0 +1,224 @@
+#include "tests.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+
+// MY TEST FUNCTIONS
+
+enum { NB_TESTS = 5 };
+
+static const char * const My_names[NB_TESTS] = {
+	"big", "small1", "small2", "small3", "small4"
+};
+
+static void My_count_test(Cutl *cutl, void *data)
+{
+	int *count = data;
+	(*count)++;
+}
+
+static void My_count_suite(Cutl *cutl, void *data)
+{
+	int *counts = data;
+	for (int i=0; i<NB_TESTS; ++i) {
+		cutl_run(cutl, My_names[i], My_count_test, &counts[i]);
+	}
+}
+
+static void My_nested_suite(Cutl *cutl, void *data)
+{
+	cutl_run(cutl, "test1", My_count_suite, data);
+}
+
+
+// Replaces the durations in the timings file, based on the test names.
+static void My_set_durations(Cutl *cutl, const char *path)
+{
+	unsigned long keys[NB_TESTS];
+	char names[NB_TESTS][32];
+	double duration;
+
+	FILE *file = fopen(path, "r");
+	cutl_check(cutl, file != NULL, "Could not open timings file.");
+	int nb_lines = 0;
+	while (nb_lines < NB_TESTS && fscanf(
+		file, "%lx %lf %31s", &keys[nb_lines], &duration,
+		names[nb_lines]) == 3
+	) {
+		nb_lines++;
+	}
+	fclose(file);
+	cutl_check(cutl, nb_lines == NB_TESTS, "Missing timings.");
+
+	file = fopen(path, "w");
+	cutl_check(cutl, file != NULL, "Could not open timings file.");
+	for (int i=0; i<NB_TESTS; ++i) {
+		duration = strcmp(names[i], "suite/big") == 0 ? 8.0 : 1.0;
+		fprintf(file, "%08lx %f %s\n", keys[i], duration, names[i]);
+	}
+	fclose(file);
+}
+
+
+// Returns whether the file has a line ending with the name.
+static bool My_has_timing(FILE *file, const char *name)
+{
+	char line[128];
+	rewind(file);
+	while (fgets(line, sizeof(line), file) != NULL) {
+		char *space = strrchr(line, ' ');
+		line[strcspn(line, "\n")] = '\0';
+		if (space != NULL && strcmp(space + 1, name) == 0) return true;
+	}
+	return false;
+}
+
+
+
+/** Durations of the tests are written by cutl_summary().
+ */
+static void write_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	int counts[NB_TESTS] = {0};
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+	cutl_set_timings(fix->cutl, path);
+	cutl_run_as_suite(fix->cutl, "suite", My_nested_suite, counts);
+
+	// Function under test
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	FILE *file = fopen(path, "r");
+	cutl_assert(cutl, file != NULL, "No timings file.");
+	cutl_assert_true(cutl, My_has_timing(file, "suite/test1"));
+	cutl_assert_false(cutl, My_has_timing(file, "suite/test1/big"));
+	cutl_assert_false(cutl, My_has_timing(file, "suite"));
+
+	// Cleanup
+	fclose(file);
+	remove(path);
+}
+
+
+/** Durations of the tests that did not run are kept.
+ */
+static void keep_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	FILE *file = fopen(path, "w");
+	cutl_check(cutl, file != NULL, "Could not open timings file.");
+	fprintf(file, "00000001 1.500000 old/test\n");
+	fclose(file);
+
+	int counts[NB_TESTS] = {0};
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+	cutl_set_timings(fix->cutl, path);
+	cutl_run_as_suite(fix->cutl, "suite", My_count_suite, counts);
+
+	// Function under test
+	cutl_summary(fix->cutl);
+
+	// Asserts
+	file = fopen(path, "r");
+	cutl_assert(cutl, file != NULL, "No timings file.");
+	cutl_assert_true(cutl, My_has_timing(file, "old/test"));
+	for (int i=0; i<NB_TESTS; ++i) {
+		char name[32];
+		sprintf(name, "suite/%s", My_names[i]);
+		cutl_assert(cutl, My_has_timing(file, name), "No %s.", name);
+	}
+
+	// Cleanup
+	fclose(file);
+	remove(path);
+}
+
+
+/** Shards are balanced from the durations of the tests.
+ */
+static void balance_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	int counts[NB_TESTS] = {0};
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+	cutl_set_timings(fix->cutl, path);
+	cutl_run_as_suite(fix->cutl, "suite", My_count_suite, counts);
+	cutl_summary(fix->cutl);
+	My_set_durations(cutl, path);
+
+	// Function under test
+	int shards[2][NB_TESTS] = {{0}};
+	for (int i=0; i<2; ++i) {
+		cutl_set_timings(fix->cutl, path);
+		cutl_set_shard(fix->cutl, i + 1, 2);
+		cutl_run_as_suite(fix->cutl, "suite", My_count_suite, shards[i]);
+	}
+
+	// Asserts
+	cutl_assert_equal(cutl, shards[0][0], 1);
+	for (int i=1; i<NB_TESTS; ++i) {
+		cutl_assert_equal(cutl, shards[0][i], 0);
+		cutl_assert_equal(cutl, shards[1][i], 1);
+	}
+
+	// Cleanup
+	remove(path);
+}
+
+
+/** Tests without history are still run in exactly one shard.
+ */
+static void partition_test(Cutl *cutl, Fixture *fix)
+{
+	// Setup
+	char path[L_tmpnam];
+	strcpy(path, tmpnam(NULL));
+	FILE *file = fopen(path, "w");
+	cutl_check(cutl, file != NULL, "Could not open timings file.");
+	fprintf(file, "00000001 1.500000 old/test\n");
+	fclose(file);
+
+	int counts[NB_TESTS] = {0};
+	cutl_set_verbosity(fix->cutl, CUTL_SILENT);
+
+	// Function under test
+	for (int i=1; i<=3; ++i) {
+		cutl_set_timings(fix->cutl, path);
+		cutl_set_shard(fix->cutl, i, 3);
+		cutl_run_as_suite(fix->cutl, "suite", My_count_suite, counts);
+	}
+
+	// Asserts
+	cutl_assert_equal(cutl, cutl_get_passed(fix->cutl), NB_TESTS);
+	for (int i=0; i<NB_TESTS; ++i) {
+		cutl_assert_equal(cutl, counts[i], 1);
+	}
+
+	// Cleanup
+	cutl_set_timings(fix->cutl, NULL);
+	remove(path);
+}
+
+
+
+// TIMINGS SUITE
+
+void cutl_timings_suite(Cutl *cutl)
+{
+	cutl_at_start(cutl, fixture_setup, NULL);
+	cutl_at_end(cutl, fixture_clean, NULL);
+
+	cutl_test(cutl, write_test);
+	cutl_test(cutl, keep_test);
+	cutl_test(cutl, balance_test);
+	cutl_test(cutl, partition_test);
+}
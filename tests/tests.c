@@ -51,8 +51,7 @@ static void fixture_at_interrupt(Cutl *cutl_under_test, void* data)
 
 void fixture_setup(Cutl *cutl, void *data)
 {
-	Fixture *fix = calloc(1, sizeof(*fix));
-	cutl_check(cutl, fix != NULL, "Malloc failed.");
+	Fixture *fix = cutl_alloc(cutl, sizeof(*fix));
 
 	fix->cutl = cutl_new(NULL);
 	cutl_check(cutl, fix->cutl != NULL, "Could not create test context.");
@@ -72,6 +71,9 @@ void fixture_clean(Cutl *cutl, void *data)
 
 	cutl_check(cutl, fix->output != NULL, "Output file is not opened.");
 
+	// Freed first, in case lines are still queued for the output.
+	cutl_free(fix->cutl);
+
 	if (cutl_get_failed(cutl)) {
 		char *output = read_file(cutl, fix->output);
 		cutl_message_at(
@@ -81,8 +83,6 @@ void fixture_clean(Cutl *cutl, void *data)
 	}
 
 	fclose(fix->output);
-	cutl_free(fix->cutl);
-	free(fix);
 }
 
 
@@ -42,13 +42,13 @@ typedef struct {
 
 
 /** Creates a new test context and output file. To be used with cutl_at_start().
- * Dynamically allocates a new fixture and sets it as test data.
+ * Allocates a new fixture with cutl_alloc() and sets it as test data.
  */
 void fixture_setup(Cutl *cutl, void*);
 
 
 /** Closes test context and output file. To be used with cutl_at_end().
- * Frees the dynamically allocated fixture.
+ * The fixture itself is released along with the test context.
  */
 void fixture_clean(Cutl *cutl, void*);
 